@@ -333,10 +333,14 @@ static uint8	C4TestPattern[12 * 4] =
 };
 
 static void C4ConvOAM (void);
+static inline uint8 C4ScaleRotatePixel (uint32, uint32, uint8, uint8);
+static inline uint8 C4PlaneByte (uint64, int);
 static void C4DoScaleRotate (int);
+static inline void C4PlotBits (uint16, uint8, uint8);
 static void C4DrawLine (int32, int32, int16, int32, int32, int16, uint8);
 static void C4DrawWireFrame (void);
 static void C4TransformLines (void);
+static void C4WaveColumn (uint8 *, int16, uint16, uint16, const uint16 *);
 static void C4BitPlaneWave (void);
 static void C4SprDisintegrate (void);
 static void C4ProcessSprites (void);
@@ -449,6 +453,29 @@ static void C4ConvOAM (void)
 	}
 }
 
+static inline uint8 C4ScaleRotatePixel (uint32 X, uint32 Y, uint8 w, uint8 h)
+{
+	if ((X >> 12) >= w || (Y >> 12) >= h)
+		return (0);
+
+	uint32	addr = (Y >> 12) * w + (X >> 12);
+	uint8	byte = Memory.C4RAM[0x600 + (addr >> 1)];
+	if (addr & 1)
+		byte >>= 4;
+
+	return (byte);
+}
+
+// Gathers one bitplane of 8 pixels, held one per byte with the first pixel in the low byte,
+// into a bitplane byte with the first pixel in bit 7
+static inline uint8 C4PlaneByte (uint64 pixels, int plane)
+{
+	const uint64	lsbs  = ((uint64) 0x01010101 << 32) | 0x01010101;
+	const uint64	magic = ((uint64) 0x80402010 << 32) | 0x08040201;
+
+	return ((uint8) ((((pixels >> plane) & lsbs) * magic) >> 56));
+}
+
 static void C4DoScaleRotate (int row_padding)
 {
 	int16	A, B, C, D;
@@ -537,44 +564,55 @@ static void C4DoScaleRotate (int row_padding)
 	uint32	X, Y;
 	uint8	byte;
 	int		outidx = 0;
-	uint8	bit = 0x80;
 
 	for (int y = 0; y < h; y++)
 	{
 		X = LineX;
 		Y = LineY;
 
-		for (int x = 0; x < w; x++)
+		// w is a multiple of 8, so each row is whole groups of 8 pixels sharing 4 output bytes
+		for (int x = 0; x < w; x += 8, outidx += 32)
 		{
-			if ((X >> 12) >= w || (Y >> 12) >= h)
-				byte = 0;
-			else
+			if (outidx + 17 < 0x600)
 			{
-				uint32	addr = (Y >> 12) * w + (X >> 12);
-				byte = Memory.C4RAM[0x600 + (addr >> 1)];
-				if (addr & 1)
-					byte >>= 4;
-			}
+				// The output bytes cannot be source pixels, so sample the whole group first
+				uint64	pixels = 0;
+
+				for (int i = 0; i < 8; i++)
+				{
+					pixels |= (uint64) C4ScaleRotatePixel(X, Y, w, h) << (i * 8);
+
+					X += A; // Add 1 to output x => add an A and a C
+					Y += C;
+				}
 
-			// De-bitplanify
-			if (byte & 1)
-				Memory.C4RAM[outidx]      |= bit;
-			if (byte & 2)
-				Memory.C4RAM[outidx + 1]  |= bit;
-			if (byte & 4)
-				Memory.C4RAM[outidx + 16] |= bit;
-			if (byte & 8)
-				Memory.C4RAM[outidx + 17] |= bit;
-
-			bit >>= 1;
-			if (bit == 0)
+				// De-bitplanify
+				Memory.C4RAM[outidx]      |= C4PlaneByte(pixels, 0);
+				Memory.C4RAM[outidx + 1]  |= C4PlaneByte(pixels, 1);
+				Memory.C4RAM[outidx + 16] |= C4PlaneByte(pixels, 2);
+				Memory.C4RAM[outidx + 17] |= C4PlaneByte(pixels, 3);
+			}
+			else
 			{
-				bit = 0x80;
-				outidx += 32;
+				// Output overlapping the source image: keep the pixel-by-pixel order
+				for (uint8 bit = 0x80; bit; bit >>= 1)
+				{
+					byte = C4ScaleRotatePixel(X, Y, w, h);
+
+					// De-bitplanify
+					if (byte & 1)
+						Memory.C4RAM[outidx]      |= bit;
+					if (byte & 2)
+						Memory.C4RAM[outidx + 1]  |= bit;
+					if (byte & 4)
+						Memory.C4RAM[outidx + 16] |= bit;
+					if (byte & 8)
+						Memory.C4RAM[outidx + 17] |= bit;
+
+					X += A;
+					Y += C;
+				}
 			}
-
-			X += A; // Add 1 to output x => add an A and a C
-			Y += C;
 		}
 
 		outidx += 2 + row_padding;
@@ -588,6 +626,16 @@ static void C4DoScaleRotate (int row_padding)
 	}
 }
 
+static inline void C4PlotBits (uint16 addr, uint8 bits, uint8 Color)
+{
+	Memory.C4RAM[addr + 0x300] &= ~bits;
+	Memory.C4RAM[addr + 0x301] &= ~bits;
+	if (Color & 1)
+		Memory.C4RAM[addr + 0x300] |= bits;
+	if (Color & 2)
+		Memory.C4RAM[addr + 0x301] |= bits;
+}
+
 static void C4DrawLine (int32 X1, int32 Y1, int16 Z1, int32 X2, int32 Y2, int16 Z2, uint8 Color)
 {
 	// Transform coordinates
@@ -619,6 +667,11 @@ static void C4DrawLine (int32 X1, int32 Y1, int16 Z1, int32 X2, int32 Y2, int16
 	Y2 = (int16) C4WFYVal;
 
 	// Render line
+	// Every pixel of a line gets the same color, so consecutive pixels landing in the
+	// same bitplane byte are collected and written together, up to 8 at a time.
+	uint16	run_addr = 0;
+	uint8	run_bits = 0;
+
 	for (int i = C4WFDist ? C4WFDist : 1; i > 0; i--)
 	{
 		if (X1 > 0xff && Y1 > 0xff && X1 < 0x6000 && Y1 < 0x6000)
@@ -626,17 +679,23 @@ static void C4DrawLine (int32 X1, int32 Y1, int16 Z1, int32 X2, int32 Y2, int16
 			uint16	addr = (((Y1 >> 8) >> 3) << 8) - (((Y1 >> 8) >> 3) << 6) + (((X1 >> 8) >> 3) << 4) + ((Y1 >> 8) & 7) * 2;
 			uint8	bit = 0x80 >> ((X1 >> 8) & 7);
 
-			Memory.C4RAM[addr + 0x300] &= ~bit;
-			Memory.C4RAM[addr + 0x301] &= ~bit;
-			if (Color & 1)
-				Memory.C4RAM[addr + 0x300] |= bit;
-			if (Color & 2)
-				Memory.C4RAM[addr + 0x301] |= bit;
+			if (addr != run_addr)
+			{
+				if (run_bits)
+					C4PlotBits(run_addr, run_bits, Color);
+				run_addr = addr;
+				run_bits = 0;
+			}
+
+			run_bits |= bit;
 		}
 
 		X1 += X2;
 		Y1 += Y2;
 	}
+
+	if (run_bits)
+		C4PlotBits(run_addr, run_bits, Color);
 }
 
 static void C4DrawWireFrame (void)
@@ -732,17 +791,30 @@ static void C4TransformLines (void)
 	}
 }
 
-static void C4BitPlaneWave (void)
+// One column of the wave: 40 rows of 2bpp data, running down 8 lines of a tile and
+// on to the tile below. Rows above the wave are cleared, the 8 rows at its edge get
+// the edge pattern and the rest are filled.
+static void C4WaveColumn (uint8 *dst, int16 height, uint16 mask1, uint16 mask2, const uint16 *wave)
 {
-	static uint16 bmpdata[] =
+	for (uint8 *tile = dst; tile < dst + 5 * 0x200; tile += 0x200)
 	{
-		0x0000, 0x0002, 0x0004, 0x0006, 0x0008, 0x000A, 0x000C, 0x000E,
-		0x0200, 0x0202, 0x0204, 0x0206, 0x0208, 0x020A, 0x020C, 0x020E,
-		0x0400, 0x0402, 0x0404, 0x0406, 0x0408, 0x040A, 0x040C, 0x040E,
-		0x0600, 0x0602, 0x0604, 0x0606, 0x0608, 0x060A, 0x060C, 0x060E,
-		0x0800, 0x0802, 0x0804, 0x0806, 0x0808, 0x080A, 0x080C, 0x080E
-	};
+		for (uint8 *row = tile; row < tile + 16; row += 2, height++)
+		{
+			uint16	tmp = READ_WORD(row) & mask2;
+
+			if (height >= 8)
+				tmp |= mask1 & 0xff00;
+			else
+			if (height >= 0)
+				tmp |= mask1 & wave[height];
 
+			WRITE_WORD(row, tmp);
+		}
+	}
+}
+
+static void C4BitPlaneWave (void)
+{
 	uint8	*dst = Memory.C4RAM;
 	uint32	waveptr = Memory.C4RAM[0x1f83];
 	uint16	mask1 = 0xc0c0;
@@ -753,55 +825,20 @@ static void C4BitPlaneWave (void)
 		printf("$7f80=%06x, expected %02x\n", READ_3WORD(Memory.C4RAM + 0x1f80), Memory.C4RAM[waveptr + 0xb00]);
 #endif
 
-	for (int j = 0; j < 0x10; j++)
+	// The wave edge patterns at $a00 (first plane pair) and $a10 (second) lie
+	// above everything written here, so they are read once
+	uint16	wave[2][8];
+	for (int i = 0; i < 8; i++)
 	{
-		do
-		{
-			int16	height = -((int8) Memory.C4RAM[waveptr + 0xb00]) - 16;
-
-			for (int i = 0; i < 40; i++)
-			{
-				uint16	tmp = READ_WORD(dst + bmpdata[i]) & mask2;
-				if (height >= 0)
-				{
-					if (height < 8)
-						tmp |= mask1 & READ_WORD(Memory.C4RAM + 0xa00 + height * 2);
-					else
-						tmp |= mask1 & 0xff00;
-				}
-
-				WRITE_WORD(dst + bmpdata[i], tmp);
-
-				height++;
-			}
-
-			waveptr = (waveptr + 1) & 0x7f;
-			mask1 = (mask1 >> 2) | (mask1 << 6);
-			mask2 = (mask2 >> 2) | (mask2 << 6);
-		}
-		while (mask1 != 0xc0c0);
-
-		dst += 16;
+		wave[0][i] = READ_WORD(Memory.C4RAM + 0xa00 + i * 2);
+		wave[1][i] = READ_WORD(Memory.C4RAM + 0xa10 + i * 2);
+	}
 
+	for (int j = 0; j < 0x20; j++)
+	{
 		do
 		{
-			int16	height = -((int8) Memory.C4RAM[waveptr + 0xb00]) - 16;
-
-			for (int i = 0; i < 40; i++)
-			{
-				uint16	tmp = READ_WORD(dst + bmpdata[i]) & mask2;
-				if (height >= 0)
-				{
-					if (height < 8)
-						tmp |= mask1 & READ_WORD(Memory.C4RAM + 0xa10 + height * 2);
-					else
-						tmp |= mask1 & 0xff00;
-				}
-
-				WRITE_WORD(dst + bmpdata[i], tmp);
-
-				height++;
-			}
+			C4WaveColumn(dst, -((int8) Memory.C4RAM[waveptr + 0xb00]) - 16, mask1, mask2, wave[j & 1]);
 
 			waveptr = (waveptr + 1) & 0x7f;
 			mask1 = (mask1 >> 2) | (mask1 << 6);
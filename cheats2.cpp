@@ -178,6 +178,8 @@
 #include "snes9x.h"
 #include "memmap.h"
 #include "cheats.h"
+#include "sdd1emu.h"
+#include "spc7110.h"
 
 static uint8 S9xGetByteFree (uint32);
 static void S9xSetByteFree (uint8, uint32);
@@ -272,6 +274,12 @@ void S9xRemoveCheat (uint32 which1)
 			*(ptr + (address & 0xffff)) = Cheat.c[which1].saved_byte;
 		else
 			S9xSetByteFree(Cheat.c[which1].saved_byte, address);
+
+		// A patched ROM byte may be inside a cached S-DD1 block or SPC7110 stream
+		if (Settings.SDD1)
+			SDD1_flush_cache();
+		if (Settings.SPC7110)
+			S9xSPC7110FlushCache();
 	}
 }
 
@@ -317,6 +325,11 @@ void S9xApplyCheat (uint32 which1)
 		*(ptr + (address & 0xffff)) = Cheat.c[which1].byte;
 	else
 		S9xSetByteFree(Cheat.c[which1].byte, address);
+
+	if (Settings.SDD1)
+		SDD1_flush_cache();
+	if (Settings.SPC7110)
+		S9xSPC7110FlushCache();
 }
 
 void S9xApplyCheats (void)
@@ -187,8 +187,41 @@ static uint8	region_map[6][6] =
 	{ 0,    0,    0,    0,    0, 0x10 }
 };
 
+// HDMA window effects rewrite the window registers every line, but usually cycle through the same
+// few hundred settings each frame. Computed clip windows are cached by the register state they depend on.
+
+#define CLIP_CACHE_SETS	256
+#define CLIP_CACHE_WAYS	2
+
+struct ClipKey
+{
+	uint8	Window1Left;
+	uint8	Window1Right;
+	uint8	Window2Left;
+	uint8	Window2Right;
+	uint8	Logic[6];
+	uint8	MainWindow;
+	uint8	SubWindow;
+	uint8	ColorWindow;
+	uint8	Disable;
+	uint8	Pad[2];
+};
+
+struct ClipCacheEntry
+{
+	struct ClipKey	Key;
+	struct ClipData	Clip[2][6];
+};
+
+static struct ClipCacheEntry	ClipCache[CLIP_CACHE_SETS][CLIP_CACHE_WAYS];
+static struct ClipKey			LastClipKey;
+static bool8					LastClipKeyValid = FALSE;
+
 static inline uint8 CalcWindowMask (int, uint8, uint8);
 static inline void StoreWindowRegions (uint8, struct ClipData *, int, int16 *, uint8 *, bool8, bool8 s = FALSE);
+static void ComputeClipWindows (void);
+static inline void MakeClipKey (struct ClipKey *);
+static inline uint32 HashClipKey (const struct ClipKey *);
 
 
 static inline uint8 CalcWindowMask (int i, uint8 W1, uint8 W2)
@@ -270,7 +303,90 @@ static inline void StoreWindowRegions (uint8 Mask, struct ClipData *Clip, int n_
 	Clip->Count = ct;
 }
 
+static inline void MakeClipKey (struct ClipKey *Key)
+{
+	memset(Key, 0, sizeof(struct ClipKey));
+
+	Key->Window1Left  = PPU.Window1Left;
+	Key->Window1Right = PPU.Window1Right;
+	Key->Window2Left  = PPU.Window2Left;
+	Key->Window2Right = PPU.Window2Right;
+
+	for (int i = 0; i < 6; i++)
+		Key->Logic[i] = (PPU.ClipWindow1Enable[i] ? 0x01 : 0) | (PPU.ClipWindow2Enable[i] ? 0x02 : 0) |
+		                (PPU.ClipWindow1Inside[i] ? 0x04 : 0) | (PPU.ClipWindow2Inside[i] ? 0x08 : 0) |
+		                (PPU.ClipWindowOverlapLogic[i] << 4);
+
+	Key->MainWindow  = Memory.FillRAM[0x212e];
+	Key->SubWindow   = Memory.FillRAM[0x212f];
+	Key->ColorWindow = Memory.FillRAM[0x2130] & 0xf0;
+	Key->Disable     = Settings.DisableGraphicWindows ? 1 : 0;
+}
+
+static inline uint32 HashClipKey (const struct ClipKey *Key)
+{
+	const uint8	*b = (const uint8 *) Key;
+	uint32		h = 2166136261u;
+
+	for (unsigned i = 0; i < sizeof(struct ClipKey); i++)
+		h = (h ^ b[i]) * 16777619u;
+
+	return ((h ^ (h >> 16)) & (CLIP_CACHE_SETS - 1));
+}
+
 void S9xComputeClipWindows (void)
+{
+	struct ClipKey			Key;
+	struct ClipCacheEntry	*Set, Tmp;
+
+	MakeClipKey(&Key);
+
+	// IPPU.Clip still holds the windows for this state
+	if (LastClipKeyValid && !memcmp(&Key, &LastClipKey, sizeof(struct ClipKey)))
+		return;
+
+	LastClipKey      = Key;
+	LastClipKeyValid = TRUE;
+
+	Set = ClipCache[HashClipKey(&Key)];
+
+	for (int w = 0; w < CLIP_CACHE_WAYS; w++)
+	{
+		if (Set[w].Key.Disable != 0xff && !memcmp(&Key, &Set[w].Key, sizeof(struct ClipKey)))
+		{
+			memcpy(IPPU.Clip, Set[w].Clip, sizeof(IPPU.Clip));
+
+			if (w)
+			{
+				Tmp    = Set[w];
+				Set[w] = Set[0];
+				Set[0] = Tmp;
+			}
+
+			return;
+		}
+	}
+
+	ComputeClipWindows();
+
+	// replace the least recently used way
+	for (int w = CLIP_CACHE_WAYS - 1; w > 0; w--)
+		Set[w] = Set[w - 1];
+
+	Set[0].Key = Key;
+	memcpy(Set[0].Clip, IPPU.Clip, sizeof(IPPU.Clip));
+}
+
+void S9xResetClipCache (void)
+{
+	for (int s = 0; s < CLIP_CACHE_SETS; s++)
+		for (int w = 0; w < CLIP_CACHE_WAYS; w++)
+			ClipCache[s][w].Key.Disable = 0xff;
+
+	LastClipKeyValid = FALSE;
+}
+
+static void ComputeClipWindows (void)
 {
 	int16	windows[6] = { 0, 256, 256, 256, 256, 256 };
 	uint8	drawing_modes[5] = { 0, 0, 0, 0, 0 };
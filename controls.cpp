@@ -2529,10 +2529,11 @@ void S9xApplyCommand (s9xcommand_t cmd, int16 data1, int16 data2)
 								return;
 
 							int	frameDest = atoi(frameno);
-							if (frameDest > 0 && frameDest > (int) S9xMovieGetFrameCounter())
+							if (frameDest > 0)
 							{
-								int	distance = frameDest - S9xMovieGetFrameCounter();
-								Settings.HighSpeedSeek = distance;
+								int	distance = S9xMovieSeek(frameDest);
+								if (distance > 0)
+									Settings.HighSpeedSeek = distance;
 							}
 						}
 
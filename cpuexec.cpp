@@ -182,6 +182,7 @@
 #include "apu/apu.h"
 #include "fxemu.h"
 #include "snapshot.h"
+#include "movie.h"
 #ifdef DEBUGGER
 #include "debug.h"
 #include "missing.h"
@@ -305,7 +306,13 @@ void S9xMainLoop (void)
 		(*Opcodes[Op].S9xOpcode)();
 
 		if (SA1.Executing)
-			S9xSA1MainLoop();
+		{
+			SA1.Budget += SA1_OPS_PER_CPU_OP;
+
+			// With SA-1 IRQs enabled on the S-CPU side, run in step so they are seen on the next instruction
+			if (Memory.FillRAM[0x2201] & 0xa0)
+				S9xSA1Sync();
+		}
 
 	#if (S9X_ACCURACY_LEVEL <= 2)
 		while (CPU.Cycles >= CPU.NextEvent)
@@ -313,6 +320,9 @@ void S9xMainLoop (void)
 	#endif
 	}
 
+	if (Settings.SA1)
+		S9xSA1Sync();
+
 	S9xPackStatus();
 
 	if (CPU.Flags & SCAN_KEYS_FLAG)
@@ -322,6 +332,8 @@ void S9xMainLoop (void)
 	#endif
 		S9xSyncSpeed();
 		CPU.Flags &= ~SCAN_KEYS_FLAG;
+
+		S9xMovieUpdateKeyframe();
 	}
 }
 
@@ -386,6 +398,10 @@ void S9xDoHEventProcessing (void)
 	CPU.WaitCounter++;
 #endif
 
+	// Bound how far the SA-1 can fall behind
+	if (Settings.SA1)
+		S9xSA1Sync();
+
 	switch (CPU.WhichEvent)
 	{
 		case HC_HBLANK_START_EVENT:
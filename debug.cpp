@@ -227,6 +227,9 @@ static const char	*HelpMessage[] =
 	"H                      - Toggle on-screen HDMA tracing",
 	"U                      - Toggle on-screen unknown register read/write tracing",
 	"P                      - Toggle on-screen DSP tracing",
+#ifdef DSP_PROFILE
+	"dspprof                - Show and clear DSP command counters",
+#endif
 	"S                      - Dump sprite (OBJ) status",
 	"g [Address]            - Go or go to [Address]",
 	"u [Address]            - Disassemble from PC or [Address]",
@@ -1386,6 +1389,15 @@ static void debug_process_command (char *Line)
 		return;
 	}
 
+#ifdef DSP_PROFILE
+	if (strncasecmp(Line, "dspprof", 7) == 0)
+	{
+		S9xPrintDSPProfile();
+		S9xResetDSPProfile();
+		return;
+	}
+#endif
+
 	if (*Line == 'i')
 	{
 		printf("Vectors:\n");
@@ -194,7 +194,15 @@ extern SPC7110	s7emu;
 static uint8	sdd1_decode_buffer[0x10000];
 
 static inline bool8 addCyclesInDMA (uint8);
+static inline uint8 * HDMATablePointer (uint32, int);
+static inline uint8 HDMAGetByte (uint32);
+static inline uint16 HDMAGetWord (uint32);
 static inline bool8 HDMAReadLineCount (int);
+static inline int32 DMABlockLength (uint8, int32);
+static inline bool8 VRAMWritesUnchecked (void);
+static bool8 DMABlockEligible (SDMA *);
+static void DMABlockToVRAM (uint8 *, uint16, int32, int32, uint32, uint32);
+static void DMABlockTransfer (SDMA *, uint8 *, uint16, int32, int32, int32);
 
 
 static inline bool8 addCyclesInDMA (uint8 dma_channel)
@@ -220,8 +228,130 @@ static inline bool8 addCyclesInDMA (uint8 dma_channel)
 	return (TRUE);
 }
 
+static inline int32 DMABlockLength (uint8 dma_channel, int32 count)
+{
+	// Number of bytes that can be moved before the next H event is due.
+	// Within that run addCyclesInDMA() would do nothing but add cycles.
+	// The last byte of the run is always left to the byte loops.
+	if (CPU.HDMARanInDMA & (1 << dma_channel))
+		return (0);
+
+	int32	n = (CPU.NextEvent - CPU.Cycles - 1) / SLOW_ONE_CYCLE;
+
+	return ((n < count - 1) ? n : count - 1);
+}
+
+static inline bool8 VRAMWritesUnchecked (void)
+{
+	// TRUE if CHECK_INBLANK() neither blocks nor reports the writes.
+	if (PPU.ForcedBlanking || CPU.V_Counter >= PPU.ScreenHeight + FIRST_VISIBLE_LINE)
+		return (TRUE);
+
+#ifdef DEBUGGER
+	return (FALSE);
+#else
+	return (!Settings.BlockInvalidVRAMAccess);
+#endif
+}
+
+static bool8 DMABlockEligible (SDMA *d)
+{
+	if (d->TransferMode == 0 || d->TransferMode == 2 || d->TransferMode == 6)
+	{
+		switch (d->BAddress)
+		{
+			case 0x04: // OAMDATA
+			case 0x22: // CGDATA
+			case 0x80: // WMDATA
+				return (TRUE);
+
+			case 0x18: // VMDATAL
+			case 0x19: // VMDATAH
+				return (!PPU.VMA.FullGraphicCount && VRAMWritesUnchecked());
+
+			default:
+				return (FALSE);
+		}
+	}
+
+	if (d->TransferMode == 1 || d->TransferMode == 5)
+		return (d->BAddress == 0x18 && !PPU.VMA.FullGraphicCount && VRAMWritesUnchecked());
+
+	return (FALSE);
+}
+
+static void DMABlockToVRAM (uint8 *base, uint16 p, int32 inc, int32 n, uint32 hi, uint32 step)
+{
+	// Same as n calls of REGISTER_2118_linear / REGISTER_2119_linear.
+	// Byte k goes to the high half if (hi + k * step) is odd.
+	// The tile cache is invalidated once per 16-byte row, in the order the writes reach the rows:
+	// invalidating a tile that is already gone is a no-op, so the cache ends up in the same state.
+	uint32	last = 0xffffffff;
+
+	for (int32 k = 0; k < n; k++, p += inc, hi ^= step)
+	{
+		uint32	address = ((PPU.VMA.Address << 1) + hi) & 0xffff;
+
+		Memory.VRAM[address] = *(base + p);
+
+		if ((address >> 4) != last)
+		{
+			last = address >> 4;
+			S9xInvalidateCachedTiles(address);
+		}
+
+		if (hi ? PPU.VMA.High : !PPU.VMA.High)
+			PPU.VMA.Address += PPU.VMA.Increment;
+	}
+}
+
+static void DMABlockTransfer (SDMA *d, uint8 *base, uint16 p, int32 inc, int32 n, int32 b)
+{
+	// DMA BLOCK PATH
+	// Writes n bytes for a transfer DMABlockEligible() accepted.
+	// Cycles and counters are left to the caller.
+	switch (d->BAddress)
+	{
+		case 0x04: // OAMDATA
+			for (int32 k = 0; k < n; k++, p += inc)
+				REGISTER_2104(*(base + p));
+
+			break;
+
+		case 0x18: // VMDATAL
+			if (d->TransferMode == 1 || d->TransferMode == 5)
+				DMABlockToVRAM(base, p, inc, n, b & 1, 1);
+			else
+				DMABlockToVRAM(base, p, inc, n, 0, 0);
+
+			break;
+
+		case 0x19: // VMDATAH
+			DMABlockToVRAM(base, p, inc, n, 1, 0);
+			break;
+
+		case 0x22: // CGDATA
+			for (int32 k = 0; k < n; k++, p += inc)
+				REGISTER_2122(*(base + p));
+
+			break;
+
+		case 0x80: // WMDATA
+			if (!CPU.InWRAMDMAorHDMA)
+			{
+				for (int32 k = 0; k < n; k++, p += inc)
+					REGISTER_2180(*(base + p));
+			}
+
+			break;
+	}
+}
+
 bool8 S9xDoDMA (uint8 Channel)
 {
+	if (Settings.SA1)
+		S9xSA1Sync();
+
 	CPU.InDMA = TRUE;
     CPU.InDMAorHDMA = TRUE;
 	CPU.CurrentDMAorHDMAChannel = Channel;
@@ -312,7 +442,11 @@ bool8 S9xDoDMA (uint8 Channel)
 			if (in_ptr)
 			{
 				in_ptr += d->AAddress;
-				SDD1_decompress(sdd1_decode_buffer, in_ptr, d->TransferBytes);
+				// Blocks from ROM never change, so their output can be reused
+				if (in_ptr >= Memory.ROM && in_ptr < Memory.ROM + Memory.CalculatedSize)
+					SDD1_decompress_cached(sdd1_decode_buffer, in_ptr, d->TransferBytes);
+				else
+					SDD1_decompress(sdd1_decode_buffer, in_ptr, d->TransferBytes);
 			}
 		#ifdef DEBUGGER
 			else
@@ -401,18 +535,7 @@ bool8 S9xDoDMA (uint8 Channel)
 							uint8	*q = line;
 							for (int32 l = 0; l < 8; l++, q += bytes_per_line)
 							{
-								for (int32 b = 0; b < 2; b++)
-								{
-									uint8	r = *(q + b);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 0) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 1) & 1);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 2) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 3) & 1);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 4) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 5) & 1);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 6) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 7) & 1);
-								}
+								S9xSA1PlanarRow(p, S9xSA1UnpackRow(q, 2), 2);
 
 								p += 2;
 							}
@@ -430,18 +553,7 @@ bool8 S9xDoDMA (uint8 Channel)
 							uint8	*q = line;
 							for (int32 l = 0; l < 8; l++, q += bytes_per_line)
 							{
-								for (int32 b = 0; b < 4; b++)
-								{
-									uint8	r = *(q + b);
-									*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-									*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-									*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-									*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-									*(p +  0) = (*(p +  0) << 1) | ((r >> 4) & 1);
-									*(p +  1) = (*(p +  1) << 1) | ((r >> 5) & 1);
-									*(p + 16) = (*(p + 16) << 1) | ((r >> 6) & 1);
-									*(p + 17) = (*(p + 17) << 1) | ((r >> 7) & 1);
-								}
+								S9xSA1PlanarRow(p, S9xSA1UnpackRow(q, 4), 4);
 
 								p += 2;
 							}
@@ -461,18 +573,7 @@ bool8 S9xDoDMA (uint8 Channel)
 							uint8	*q = line;
 							for (int32 l = 0; l < 8; l++, q += bytes_per_line)
 							{
-								for (int32 b = 0; b < 8; b++)
-								{
-									uint8	r = *(q + b);
-									*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-									*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-									*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-									*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-									*(p + 32) = (*(p + 32) << 1) | ((r >> 4) & 1);
-									*(p + 33) = (*(p + 33) << 1) | ((r >> 5) & 1);
-									*(p + 48) = (*(p + 48) << 1) | ((r >> 6) & 1);
-									*(p + 49) = (*(p + 49) << 1) | ((r >> 7) & 1);
-								}
+								S9xSA1PlanarRow(p, S9xSA1UnpackRow(q, 8), 8);
 
 								p += 2;
 							}
@@ -726,6 +827,33 @@ bool8 S9xDoDMA (uint8 Channel)
 			else
 			{
 				// DMA FAST PATH
+				// Bytes in front of the next H event are moved as one block with one cycle update,
+				// the byte that reaches the event goes through UPDATE_COUNTERS as usual.
+				while (count > 1 && DMABlockEligible(d))
+				{
+					int32	n = DMABlockLength(Channel, count);
+
+					if (n > 0)
+					{
+						DMABlockTransfer(d, base, p, inc, n, b);
+						ADD_CYCLES(n * SLOW_ONE_CYCLE);
+						CPU.HDMARanInDMA = 0;
+						d->TransferBytes -= n;
+						d->AAddress += n * inc;
+						p += n * inc;
+					}
+					else
+					{
+						n = 1;
+						DMABlockTransfer(d, base, p, inc, n, b);
+						UPDATE_COUNTERS;
+					}
+
+					count -= n;
+					if (d->TransferMode == 1 || d->TransferMode == 5)
+						b = (b + n) & 1;
+				}
+
 				if (d->TransferMode == 0 || d->TransferMode == 2 || d->TransferMode == 6)
 				{
 					switch (d->BAddress)
@@ -1310,13 +1438,40 @@ bool8 S9xDoDMA (uint8 Channel)
 	return (TRUE);
 }
 
+static inline uint8 * HDMATablePointer (uint32 Address, int bytes)
+{
+	// HDMA tables in ROM are decoded straight from memory as long as the bytes stay in one block.
+	// Everything else goes through S9xGetByte() / S9xGetWord() for their side effects.
+	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
+	uint8	*GetAddress = Memory.Map[block];
+
+	if (!Memory.BlockIsROM[block] || GetAddress < (uint8 *) CMemory::MAP_LAST || (Address & MEMMAP_MASK) + bytes > MEMMAP_BLOCK_SIZE)
+		return (NULL);
+
+	return (GetAddress + (Address & 0xffff));
+}
+
+static inline uint8 HDMAGetByte (uint32 Address)
+{
+	uint8	*ptr = HDMATablePointer(Address, 1);
+
+	return (ptr ? *ptr : S9xGetByte(Address));
+}
+
+static inline uint16 HDMAGetWord (uint32 Address)
+{
+	uint8	*ptr = HDMATablePointer(Address, 2);
+
+	return (ptr ? READ_WORD(ptr) : S9xGetWord(Address));
+}
+
 static inline bool8 HDMAReadLineCount (int d)
 {
 	// CPU.InDMA is set, so S9xGetXXX() / S9xSetXXX() incur no charges.
 
 	uint8	line;
 
-	line = S9xGetByte((DMA[d].ABank << 16) + DMA[d].Address);
+	line = HDMAGetByte((DMA[d].ABank << 16) + DMA[d].Address);
 	ADD_CYCLES(SLOW_ONE_CYCLE);
 
 	if (!line)
@@ -1334,7 +1489,7 @@ static inline bool8 HDMAReadLineCount (int d)
 			else
 				ADD_CYCLES(SLOW_ONE_CYCLE);
 
-			DMA[d].IndirectAddress = S9xGetWord((DMA[d].ABank << 16) + DMA[d].Address);
+			DMA[d].IndirectAddress = HDMAGetWord((DMA[d].ABank << 16) + DMA[d].Address);
 			DMA[d].Address++;
 		}
 
@@ -1361,7 +1516,7 @@ static inline bool8 HDMAReadLineCount (int d)
 	if (DMA[d].HDMAIndirectAddressing)
 	{
 		ADD_CYCLES(SLOW_ONE_CYCLE << 1);
-		DMA[d].IndirectAddress = S9xGetWord((DMA[d].ABank << 16) + DMA[d].Address);
+		DMA[d].IndirectAddress = HDMAGetWord((DMA[d].ABank << 16) + DMA[d].Address);
 		DMA[d].Address += 2;
 		HDMAMemPointers[d] = S9xGetMemPointer((DMA[d].IndirectBank << 16) + DMA[d].IndirectAddress);
 	}
@@ -180,10 +180,23 @@
 #ifdef DEBUGGER
 #include "missing.h"
 #endif
+#ifdef DSP_PROFILE
+#include <time.h>
+#endif
 
 uint8	(*GetDSP) (uint16)        = NULL;
 void	(*SetDSP) (uint8, uint16) = NULL;
 
+#ifdef DSP_PROFILE
+static inline uint64 DSPClock (void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64) ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+#endif
+
 
 void S9xResetDSP (void)
 {
@@ -199,8 +212,30 @@ void S9xResetDSP (void)
 
 	memset(&DSP4, 0, sizeof(DSP4));
 	DSP4.waiting4command = TRUE;
+
+#ifdef DSP_PROFILE
+	S9xResetDSPProfile();
+#endif
+}
+
+#ifdef DSP_PROFILE
+void S9xResetDSPProfile (void)
+{
+	memset(&DSPProfile, 0, sizeof(DSPProfile));
 }
 
+void S9xPrintDSPProfile (void)
+{
+	printf("cmd   started     reads    writes        usec\n");
+
+	for (int i = 0; i < 256; i++)
+	{
+		if (DSPProfile.commands[i] || DSPProfile.reads[i] || DSPProfile.writes[i])
+			printf(" %02x %9u %9u %9u %11u\n", i, DSPProfile.commands[i], DSPProfile.reads[i], DSPProfile.writes[i], (uint32) (DSPProfile.nanoseconds[i] / 1000));
+	}
+}
+#endif
+
 uint8 S9xGetDSP (uint16 address)
 {
 #ifdef DEBUGGER
@@ -211,7 +246,16 @@ uint8 S9xGetDSP (uint16 address)
 	}
 #endif
 
+#ifdef DSP_PROFILE
+	DSPProfile.reads[DSPProfile.command]++;
+
+	uint64	start = DSPClock();
+	uint8	byte = (*GetDSP)(address);
+	DSPProfile.nanoseconds[DSPProfile.command] += DSPClock() - start;
+	return (byte);
+#else
 	return ((*GetDSP)(address));
+#endif
 }
 
 void S9xSetDSP (uint8 byte, uint16 address)
@@ -225,5 +269,14 @@ void S9xSetDSP (uint8 byte, uint16 address)
 	}
 #endif
 
+#ifdef DSP_PROFILE
+	DSPProfile.writes[DSPProfile.command]++;
+
+	uint8	command = DSPProfile.command;
+	uint64	start = DSPClock();
 	(*SetDSP)(byte, address);
+	DSPProfile.nanoseconds[command] += DSPClock() - start;
+#else
+	(*SetDSP)(byte, address);
+#endif
 }
@@ -593,15 +593,41 @@ struct SDSP4
 	int16	OAM_Row[32];		// current number of tiles per row
 };
 
+#ifdef DSP_PROFILE
+struct SDSPProfile
+{
+	uint8	command;			// command the port traffic below is charged to
+	uint32	commands[256];		// commands started
+	uint32	reads[256];			// data/status port reads
+	uint32	writes[256];		// data/status port writes
+	uint64	nanoseconds[256];	// time in the port handlers
+};
+#endif
+
 extern struct SDSP0	DSP0;
 extern struct SDSP1	DSP1;
 extern struct SDSP2	DSP2;
 extern struct SDSP3	DSP3;
 extern struct SDSP4	DSP4;
+#ifdef DSP_PROFILE
+extern struct SDSPProfile	DSPProfile;
+#endif
+
+static inline void S9xDSPCommand (uint8 command)
+{
+#ifdef DSP_PROFILE
+	DSPProfile.command = command;
+	DSPProfile.commands[command]++;
+#endif
+}
 
 uint8 S9xGetDSP (uint16);
 void S9xSetDSP (uint8, uint16);
 void S9xResetDSP (void);
+#ifdef DSP_PROFILE
+void S9xResetDSPProfile (void);
+void S9xPrintDSPProfile (void);
+#endif
 uint8 DSP1GetByte (uint16);
 void DSP1SetByte (uint8, uint16);
 uint8 DSP2GetByte (uint16);
@@ -1282,6 +1282,7 @@ void DSP1SetByte (uint8 byte, uint16 address)
 			DSP1.in_index        = 0;
 			DSP1.waiting4command = FALSE;
 			DSP1.first_parameter = TRUE;
+			S9xDSPCommand(byte);
 			#ifdef DEBUGGER
 				//printf("OP%02X\n",byte);
 			#endif
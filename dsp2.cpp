@@ -400,6 +400,7 @@ void DSP2SetByte (uint8 byte, uint16 address)
 			DSP2.command         = byte;
 			DSP2.in_index        = 0;
 			DSP2.waiting4command = FALSE;
+			S9xDSPCommand(byte);
 
 			switch (byte)
 			{
@@ -1189,6 +1189,8 @@ static void DSP3_Command (void)
 {
 	if (DSP3.DR < 0x40)
 	{
+		S9xDSPCommand((uint8) DSP3.DR);
+
 		switch (DSP3.DR)
 		{
 			case 0x02: SetDSP3 = &DSP3_Coordinate; break;
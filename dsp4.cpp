@@ -233,6 +233,7 @@ static void DSP4_OP0E (void);
 static void DSP4_OP0F (void);
 static void DSP4_OP10 (void);
 static void DSP4_OP11 (int16, int16, int16, int16, int16 *);
+static void DSP4_Rasterize (int32, int32, int32, int32);
 static void DSP4_SetByte (void);
 static void DSP4_GetByte (void);
 
@@ -286,6 +287,29 @@ static void DSP4_Multiply (int16 Multiplicand, int16 Multiplier, int32 *Product)
 	*Product = (Multiplicand * Multiplier << 1) >> 1;
 }
 
+// write a whole segment of raster lines at once: for each line, the HDMA
+// memory pointer and the vertical and horizontal scroll offsets
+static void DSP4_Rasterize (int32 x_scroll, int32 y_scroll, int32 px_dx, int32 py_dy)
+{
+	uint8	*p = DSP4.output + DSP4.out_count;
+	int16	ptr = DSP4.poly_ptr[0][0];
+
+	for (DSP4.lcv = 0; DSP4.lcv < DSP4.segments; DSP4.lcv++)
+	{
+		WRITE_WORD(p + 0, ptr);
+		WRITE_WORD(p + 2, (y_scroll + 0x8000) >> 16);
+		WRITE_WORD(p + 4, (x_scroll + 0x8000) >> 16);
+		p += 6;
+
+		ptr -= 4;
+		x_scroll += px_dx;
+		y_scroll += py_dy;
+	}
+
+	DSP4.out_count = p - DSP4.output;
+	DSP4.poly_ptr[0][0] = ptr;
+}
+
 static void DSP4_OP01 (void)
 {
 	DSP4.waiting4command = FALSE;
@@ -401,23 +425,11 @@ static void DSP4_OP01 (void)
 
 			// SR = 0x80
 
-			// rasterize line
-			for (DSP4.lcv = 0; DSP4.lcv < DSP4.segments; DSP4.lcv++)
-			{
-				// 1. HDMA memory pointer (bg1)
-				// 2. vertical scroll offset ($210E)
-				// 3. horizontal scroll offset ($210D)
-				DSP4_WRITE_WORD(DSP4.poly_ptr[0][0]);
-				DSP4_WRITE_WORD((y_scroll + 0x8000) >> 16);
-				DSP4_WRITE_WORD((x_scroll + 0x8000) >> 16);
-
-				// update memory address
-				DSP4.poly_ptr[0][0] -= 4;
-
-				// update screen values
-				x_scroll += px_dx;
-				y_scroll += py_dy;
-			}
+			// rasterize lines
+			// 1. HDMA memory pointer (bg1)
+			// 2. vertical scroll offset ($210E)
+			// 3. horizontal scroll offset ($210D)
+			DSP4_Rasterize(x_scroll, y_scroll, px_dx, py_dy);
 		}
 
 		////////////////////////////////////////////////////
@@ -623,23 +635,11 @@ static void DSP4_OP07 (void)
 
 			// SR = 0x80
 
-			// rasterize line
-			for (DSP4.lcv = 0; DSP4.lcv < DSP4.segments; DSP4.lcv++)
-			{
-				// 1. HDMA memory pointer (bg2)
-				// 2. vertical scroll offset ($2110)
-				// 3. horizontal scroll offset ($210F)
-				DSP4_WRITE_WORD(DSP4.poly_ptr[0][0]);
-				DSP4_WRITE_WORD((y_scroll + 0x8000) >> 16);
-				DSP4_WRITE_WORD((x_scroll + 0x8000) >> 16);
-
-				// update memory address
-				DSP4.poly_ptr[0][0] -= 4;
-
-				// update screen values
-				x_scroll += px_dx;
-				y_scroll += py_dy;
-			}
+			// rasterize lines
+			// 1. HDMA memory pointer (bg2)
+			// 2. vertical scroll offset ($2110)
+			// 3. horizontal scroll offset ($210F)
+			DSP4_Rasterize(x_scroll, y_scroll, px_dx, py_dy);
 		}
 
 		/////////////////////////////////////////////////////
@@ -1449,23 +1449,11 @@ static void DSP4_OP0D (void)
 
 			// SR = 0x80
 
-			// rasterize line
-			for (DSP4.lcv = 0; DSP4.lcv < DSP4.segments; DSP4.lcv++)
-			{
-				// 1. HDMA memory pointer (bg1)
-				// 2. vertical scroll offset ($210E)
-				// 3. horizontal scroll offset ($210D)
-				DSP4_WRITE_WORD(DSP4.poly_ptr[0][0]);
-				DSP4_WRITE_WORD((y_scroll + 0x8000) >> 16);
-				DSP4_WRITE_WORD((x_scroll + 0x8000) >> 16);
-
-				// update memory address
-				DSP4.poly_ptr[0][0] -= 4;
-
-				// update screen values
-				x_scroll += px_dx;
-				y_scroll += py_dy;
-			}
+			// rasterize lines
+			// 1. HDMA memory pointer (bg1)
+			// 2. vertical scroll offset ($210E)
+			// 3. horizontal scroll offset ($210D)
+			DSP4_Rasterize(x_scroll, y_scroll, px_dx, py_dy);
 		}
 
 		/////////////////////////////////////////////////////
@@ -1679,23 +1667,11 @@ static void DSP4_OP0F (void)
 
 			// SR = 0x80
 
-			// rasterize line
-			for (DSP4.lcv = 0; DSP4.lcv < DSP4.segments; DSP4.lcv++)
-			{
-				// 1. HDMA memory pointer
-				// 2. vertical scroll offset ($210E)
-				// 3. horizontal scroll offset ($210D)
-				DSP4_WRITE_WORD(DSP4.poly_ptr[0][0]);
-				DSP4_WRITE_WORD((y_scroll + 0x8000) >> 16);
-				DSP4_WRITE_WORD((x_scroll + 0x8000) >> 16);
-
-				// update memory address
-				DSP4.poly_ptr[0][0] -= 4;
-
-				// update screen values
-				x_scroll += px_dx;
-				y_scroll += py_dy;
-			}
+			// rasterize lines
+			// 1. HDMA memory pointer
+			// 2. vertical scroll offset ($210E)
+			// 3. horizontal scroll offset ($210D)
+			DSP4_Rasterize(x_scroll, y_scroll, px_dx, py_dy);
 		}
 
 		////////////////////////////////////////////////////
@@ -1923,23 +1899,11 @@ static void DSP4_OP10 (void)
 
 			// SR = 0x80
 
-			// rasterize line
-			for (DSP4.lcv = 0; DSP4.lcv < DSP4.segments; DSP4.lcv++)
-			{
-				// 1. HDMA memory pointer (bg2)
-				// 2. vertical scroll offset ($2110)
-				// 3. horizontal scroll offset ($210F)
-				DSP4_WRITE_WORD(DSP4.poly_ptr[0][0]);
-				DSP4_WRITE_WORD((y_scroll + 0x8000) >> 16);
-				DSP4_WRITE_WORD((x_scroll + 0x8000) >> 16);
-
-				// update memory address
-				DSP4.poly_ptr[0][0] -= 4;
-
-				// update screen values
-				x_scroll += px_dx;
-				y_scroll += py_dy;
-			}
+			// rasterize lines
+			// 1. HDMA memory pointer (bg2)
+			// 2. vertical scroll offset ($2110)
+			// 3. horizontal scroll offset ($210F)
+			DSP4_Rasterize(x_scroll, y_scroll, px_dx, py_dy);
 		}
 
 		/////////////////////////////////////////////////////
@@ -2009,6 +1973,7 @@ static void DSP4_SetByte (void)
 			DSP4.out_index       = 0;
 
 			DSP4.Logic = 0;
+			S9xDSPCommand((uint8) DSP4.command);
 
 			switch (DSP4.command)
 			{
@@ -175,9 +175,18 @@
  ***********************************************************************************/
 
 
+#ifdef USE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
 #include "snes9x.h"
 #include "blit.h"
 
+#if defined(__GNUC__) && defined(__x86_64__) && SNES_NTSC_OUT_DEPTH == 15
+#include <immintrin.h>
+#define NTSC_SIMD
+#endif
+
 #define ALL_COLOR_MASK	(FIRST_COLOR_MASK | SECOND_COLOR_MASK | THIRD_COLOR_MASK)
 
 #ifdef GFX_MULTI_FORMAT
@@ -191,6 +200,73 @@ static uint32	colorMask = 0;
 
 static snes_ntsc_t	*ntsc   = NULL;
 static uint8		*XDelta = NULL;
+#ifdef NTSC_SIMD
+static bool8		NTSCUseAVX2 = FALSE;
+#define NTSC_TABLE_SLACK	64
+#else
+#define NTSC_TABLE_SLACK	0
+#endif
+
+#ifdef USE_THREADS
+
+#define BLIT_MAX_THREADS	8
+#define BLIT_BAND_LINES		24	// multiple of the NTSC burst count, so each band starts on phase 0
+#define BLIT_MARGIN_LINES	2
+
+struct SBlitJob
+{
+	BlitFunc	Blit;
+	uint8		*SrcPtr;
+	int			SrcRowBytes;
+	uint8		*DstPtr;
+	int			DstRowBytes;
+	int			Width;
+	int			Height;
+	int			Scale;
+	int			NumBands;
+	int			NextBand;
+	int			DoneBands;
+};
+
+// Output lines produced per source line. 0 means the filter carries state from line to line
+// (XDelta, edge handling) and has to see the whole frame in one call.
+
+static const struct
+{
+	BlitFunc	Blit;
+	int			Scale;
+}	BlitScale[] =
+{
+	{ S9xBlitPixSmall16,         1 },
+	{ S9xBlitPixScaled16,        0 },
+	{ S9xBlitPixHiRes16,         2 },
+	{ S9xBlitPixScaledTV16,      0 },
+	{ S9xBlitPixHiResTV16,       2 },
+	{ S9xBlitPixHiResMixedTV16,  0 },
+	{ S9xBlitPixSmooth16,        0 },
+	{ S9xBlitPixSuperEagle16,    2 },
+	{ S9xBlitPix2xSaI16,         2 },
+	{ S9xBlitPixSuper2xSaI16,    2 },
+	{ S9xBlitPixEPX16,           0 },
+	{ S9xBlitPixHQ2x16,          2 },
+	{ S9xBlitPixHQ3x16,          3 },
+	{ S9xBlitPixHQ4x16,          4 },
+	{ S9xBlitPixNTSC16,          1 },
+	{ S9xBlitPixHiResNTSC16,     1 },
+	{ NULL,                      0 }
+};
+
+static struct SBlitJob	BlitJob;
+static uint8			*BlitFrame       = NULL;
+static int				BlitFrameSize    = 0;
+static bool8			BlitFramePending = FALSE;
+static pthread_t		BlitThreads[BLIT_MAX_THREADS];
+static int				BlitNumThreads = 0;
+static bool8			BlitQuit       = FALSE;
+static pthread_mutex_t	BlitMutex      = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	BlitWorkCond   = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	BlitDoneCond   = PTHREAD_COND_INITIALIZER;
+#endif
 
 
 bool8 S9xBlitFilterInit (void)
@@ -230,11 +306,16 @@ void S9xBlitClearDelta (void)
 
 bool8 S9xBlitNTSCFilterInit (void)
 {
-	ntsc = (snes_ntsc_t *) malloc(sizeof(snes_ntsc_t));
+	ntsc = (snes_ntsc_t *) calloc(1, sizeof(snes_ntsc_t) + NTSC_TABLE_SLACK);
 	if (!ntsc)
 		return (FALSE);
 
 	snes_ntsc_init(ntsc, &snes_ntsc_composite);
+
+#ifdef NTSC_SIMD
+	NTSCUseAVX2 = __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+#endif
+
 	return (TRUE);
 }
 
@@ -627,12 +708,443 @@ void S9xBlitPixHQ4x16 (uint8 *srcPtr, int srcRowBytes, uint8 *dstPtr, int dstRow
 	HQ4X_16(srcPtr, srcRowBytes, dstPtr, dstRowBytes, width, height);
 }
 
+#ifdef NTSC_SIMD
+
+// AVX2 versions of snes_ntsc_blit() and snes_ntsc_blit_hires().
+// Every output pixel is a sum of kernel entries. Within a chunk of 7 output pixels, each kernel
+// term reads one run of entries from the previous input pixel and one from the next, so a term is
+// two loads and a blend. The 7 pixels are done as two vectors of four 64-bit lanes; the 8th lane
+// is unused and may read a little past the last kernel, see NTSC_TABLE_SLACK.
+// Results are bit-identical to the scalar library.
+
+typedef snes_ntsc_rgb_t const	*NTSCKernel;
+
+#define NTSC_KERNEL(n)	SNES_NTSC_IN_FORMAT(ktable, SNES_NTSC_ADJ_IN(n))
+
+__attribute__((target("avx2"), always_inline))
+static inline __m256i NTSCTerm (NTSCKernel a, int a0, NTSCKernel b, int b0, int split, int first)
+{
+	// lanes x < split take a[a0 + x], the rest b[b0 + x]
+	__m256i	lane = _mm256_setr_epi64x(first, first + 1, first + 2, first + 3);
+	__m256i	mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(split), lane);
+	__m256i	va, vb;
+
+	va = _mm256_loadu_si256((const __m256i *) (a + a0 + first));
+
+	// only the hires kernel1 term starts one entry before b, shift it up a lane instead
+	if (b0 + first < 0)
+		vb = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *) b), 0x90);
+	else
+		vb = _mm256_loadu_si256((const __m256i *) (b + b0 + first));
+
+	return (_mm256_blendv_epi8(vb, va, mask));
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline __m256i NTSCClamp (__m256i raw, int shift)
+{
+	__m256i	sub   = _mm256_and_si256(_mm256_srli_epi64(raw, 9 - shift), _mm256_set1_epi64x(snes_ntsc_clamp_mask));
+	__m256i	clamp = _mm256_sub_epi64(_mm256_set1_epi64x(snes_ntsc_clamp_add), sub);
+
+	raw   = _mm256_or_si256(raw, clamp);
+	clamp = _mm256_sub_epi64(clamp, sub);
+	raw   = _mm256_and_si256(raw, clamp);
+
+	// 15-bit RGB out
+	return (_mm256_or_si256(_mm256_or_si256(
+		_mm256_and_si256(_mm256_srli_epi64(raw, 14 - shift), _mm256_set1_epi64x(0x7C00)),
+		_mm256_and_si256(_mm256_srli_epi64(raw,  9 - shift), _mm256_set1_epi64x(0x03E0))),
+		_mm256_and_si256(_mm256_srli_epi64(raw,  4 - shift), _mm256_set1_epi64x(0x001F))));
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline void NTSCStore (uint16 *out, __m256i lo, __m256i hi)
+{
+	// every lane holds a 15-bit value, gather the low words of the 7 used lanes
+	__m256i	idx = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+	__m128i	a   = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(lo, idx));
+	__m128i	b   = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(hi, idx));
+	__m128i	p   = _mm_packus_epi32(a, b);
+	uint64	q   = _mm_cvtsi128_si64(p);
+	uint32	r   = _mm_extract_epi32(p, 2);
+
+	memcpy(out, &q, 8);
+	memcpy(out + 4, &r, 4);
+	out[6] = _mm_extract_epi16(p, 6);
+}
+
+// f is the first output pixel of the half, always a constant so the lane masks fold away
+
+__attribute__((target("avx2"), always_inline))
+static inline __m256i NTSCHalf (int f, NTSCKernel n0, NTSCKernel n1, NTSCKernel n2, NTSCKernel k[3], NTSCKernel kx[3])
+{
+	__m256i	sum;
+
+	sum = _mm256_add_epi64(NTSCTerm(n0,    0, n0,     0, 0, f), NTSCTerm(k[0],  7, k[0],  7, 0, f));
+	sum = _mm256_add_epi64(sum, _mm256_add_epi64(NTSCTerm(k[1], 19, n1, 12, 2, f), NTSCTerm(kx[1], 26, k[1], 19, 2, f)));
+	sum = _mm256_add_epi64(sum, _mm256_add_epi64(NTSCTerm(k[2], 31, n2, 24, 4, f), NTSCTerm(kx[2], 38, k[2], 31, 4, f)));
+
+	return (NTSCClamp(sum, 1));
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline __m256i NTSCHiResHalf (int f, NTSCKernel n[6], NTSCKernel k[6], NTSCKernel kx[6])
+{
+	__m256i	sum;
+
+	sum = _mm256_add_epi64(NTSCTerm(n[0], 0, n[0], 0, 0, f), NTSCTerm(k[0], 7, k[0], 7, 0, f));
+	sum = _mm256_add_epi64(sum, _mm256_add_epi64(NTSCTerm(k[1],  6, n[1], -1, 1, f), NTSCTerm(kx[1], 13, k[1],  6, 1, f)));
+	sum = _mm256_add_epi64(sum, _mm256_add_epi64(NTSCTerm(k[2], 19, n[2], 12, 2, f), NTSCTerm(kx[2], 26, k[2], 19, 2, f)));
+	sum = _mm256_add_epi64(sum, _mm256_add_epi64(NTSCTerm(k[3], 18, n[3], 11, 3, f), NTSCTerm(kx[3], 25, k[3], 18, 3, f)));
+	sum = _mm256_add_epi64(sum, _mm256_add_epi64(NTSCTerm(k[4], 31, n[4], 24, 4, f), NTSCTerm(kx[4], 38, k[4], 31, 4, f)));
+	sum = _mm256_add_epi64(sum, _mm256_add_epi64(NTSCTerm(k[5], 30, n[5], 23, 5, f), NTSCTerm(kx[5], 37, k[5], 30, 5, f)));
+
+	return (NTSCClamp(sum, 0));
+}
+
+__attribute__((target("avx2")))
+static void NTSCChunkAVX2 (uint16 *out, NTSCKernel n0, NTSCKernel n1, NTSCKernel n2, NTSCKernel k[3], NTSCKernel kx[3])
+{
+	NTSCStore(out, NTSCHalf(0, n0, n1, n2, k, kx), NTSCHalf(4, n0, n1, n2, k, kx));
+
+	kx[1] = k[1];
+	kx[2] = k[2];
+	k[0]  = n0;
+	k[1]  = n1;
+	k[2]  = n2;
+}
+
+__attribute__((target("avx2")))
+static void NTSCHiResChunkAVX2 (uint16 *out, NTSCKernel n[6], NTSCKernel k[6], NTSCKernel kx[6])
+{
+	NTSCStore(out, NTSCHiResHalf(0, n, k, kx), NTSCHiResHalf(4, n, k, kx));
+
+	for (int i = 1; i < 6; i++)
+		kx[i] = k[i];
+	for (int i = 0; i < 6; i++)
+		k[i]  = n[i];
+}
+
+static void NTSCBlitAVX2 (const uint16 *input, long in_row_width, int in_width, int in_height, uint8 *rgb_out, long out_pitch)
+{
+	int	chunk_count = (in_width - 1) / snes_ntsc_in_chunk;
+	int	burst_phase = 0;
+
+	for (; in_height; in_height--)
+	{
+		const char		*ktable  = (const char *) ntsc->table + burst_phase * (snes_ntsc_burst_size * sizeof(snes_ntsc_rgb_t));
+		const uint16	*line_in = input;
+		uint16			*line_out = (uint16 *) rgb_out;
+		NTSCKernel		black = NTSC_KERNEL(snes_ntsc_black);
+		NTSCKernel		k[3], kx[3];
+
+		k[0] = black;
+		k[1] = black;
+		k[2] = NTSC_KERNEL(*line_in);
+		kx[1] = kx[2] = black;
+		line_in++;
+
+		for (int n = chunk_count; n; n--)
+		{
+			NTSCChunkAVX2(line_out, NTSC_KERNEL(line_in[0]), NTSC_KERNEL(line_in[1]), NTSC_KERNEL(line_in[2]), k, kx);
+			line_in  += 3;
+			line_out += 7;
+		}
+
+		NTSCChunkAVX2(line_out, black, black, black, k, kx);
+
+		burst_phase = (burst_phase + 1) % snes_ntsc_burst_count;
+		input   += in_row_width;
+		rgb_out += out_pitch;
+	}
+}
+
+static void NTSCBlitHiResAVX2 (const uint16 *input, long in_row_width, int in_width, int in_height, uint8 *rgb_out, long out_pitch)
+{
+	int	chunk_count = (in_width - 2) / (snes_ntsc_in_chunk * 2);
+	int	burst_phase = 0;
+
+	for (; in_height; in_height--)
+	{
+		const char		*ktable  = (const char *) ntsc->table + burst_phase * (snes_ntsc_burst_size * sizeof(snes_ntsc_rgb_t));
+		const uint16	*line_in = input;
+		uint16			*line_out = (uint16 *) rgb_out;
+		NTSCKernel		black = NTSC_KERNEL(snes_ntsc_black);
+		NTSCKernel		n[6], k[6], kx[6];
+
+		k[0] = k[1] = k[2] = k[3] = black;
+		k[4] = NTSC_KERNEL(line_in[0]);
+		k[5] = NTSC_KERNEL(line_in[1]);
+		kx[1] = kx[2] = kx[3] = kx[4] = kx[5] = black;
+		line_in += 2;
+
+		for (int c = chunk_count; c; c--)
+		{
+			for (int i = 0; i < 6; i++)
+				n[i] = NTSC_KERNEL(line_in[i]);
+
+			NTSCHiResChunkAVX2(line_out, n, k, kx);
+			line_in  += 6;
+			line_out += 7;
+		}
+
+		for (int i = 0; i < 6; i++)
+			n[i] = black;
+
+		NTSCHiResChunkAVX2(line_out, n, k, kx);
+
+		burst_phase = (burst_phase + 1) % snes_ntsc_burst_count;
+		input   += in_row_width;
+		rgb_out += out_pitch;
+	}
+}
+
+#undef NTSC_KERNEL
+
+#endif
+
 void S9xBlitPixNTSC16 (uint8 *srcPtr, int srcRowBytes, uint8 *dstPtr, int dstRowBytes, int width, int height)
 {
+#ifdef NTSC_SIMD
+	if (NTSCUseAVX2)
+	{
+		NTSCBlitAVX2((const uint16 *) srcPtr, srcRowBytes >> 1, width, height, dstPtr, dstRowBytes);
+		return;
+	}
+#endif
+
 	snes_ntsc_blit(ntsc, (SNES_NTSC_IN_T const *) srcPtr, srcRowBytes >> 1, 0, width, height, dstPtr, dstRowBytes);
 }
 
 void S9xBlitPixHiResNTSC16 (uint8 *srcPtr, int srcRowBytes, uint8 *dstPtr, int dstRowBytes, int width, int height)
 {
+#ifdef NTSC_SIMD
+	if (NTSCUseAVX2)
+	{
+		NTSCBlitHiResAVX2((const uint16 *) srcPtr, srcRowBytes >> 1, width, height, dstPtr, dstRowBytes);
+		return;
+	}
+#endif
+
 	snes_ntsc_blit_hires(ntsc, (SNES_NTSC_IN_T const *) srcPtr, srcRowBytes >> 1, 0, width, height, dstPtr, dstRowBytes);
 }
+
+// Banded filter pipeline.
+// The frame is cut into horizontal bands which are filtered on a small thread pool.
+// Filters only read the source rows around the band, so bands can be run in any order.
+
+#ifdef USE_THREADS
+
+static void S9xBlitRunBand (struct SBlitJob *job, int band)
+{
+	int	y = band * BLIT_BAND_LINES;
+
+	if (job->Scale == 0)
+	{
+		job->Blit(job->SrcPtr, job->SrcRowBytes, job->DstPtr, job->DstRowBytes, job->Width, job->Height);
+		return;
+	}
+
+	job->Blit(job->SrcPtr + y * job->SrcRowBytes, job->SrcRowBytes,
+			  job->DstPtr + y * job->Scale * job->DstRowBytes, job->DstRowBytes,
+			  job->Width, (job->Height - y < BLIT_BAND_LINES) ? job->Height - y : BLIT_BAND_LINES);
+}
+
+static void * S9xBlitWorker (void *)
+{
+	pthread_mutex_lock(&BlitMutex);
+
+	for (;;)
+	{
+		while (!BlitQuit && BlitJob.NextBand >= BlitJob.NumBands)
+			pthread_cond_wait(&BlitWorkCond, &BlitMutex);
+
+		if (BlitQuit)
+			break;
+
+		int	band = BlitJob.NextBand++;
+
+		pthread_mutex_unlock(&BlitMutex);
+		S9xBlitRunBand(&BlitJob, band);
+		pthread_mutex_lock(&BlitMutex);
+
+		if (++BlitJob.DoneBands == BlitJob.NumBands)
+			pthread_cond_broadcast(&BlitDoneCond);
+	}
+
+	pthread_mutex_unlock(&BlitMutex);
+
+	return (NULL);
+}
+
+static void S9xBlitStartJob (BlitFunc blit, uint8 *srcPtr, int srcRowBytes, uint8 *dstPtr, int dstRowBytes, int width, int height)
+{
+	int	scale = 0;
+
+	for (int i = 0; BlitScale[i].Blit; i++)
+	{
+		if (BlitScale[i].Blit == blit)
+		{
+			scale = BlitScale[i].Scale;
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&BlitMutex);
+
+	BlitJob.Blit        = blit;
+	BlitJob.SrcPtr      = srcPtr;
+	BlitJob.SrcRowBytes = srcRowBytes;
+	BlitJob.DstPtr      = dstPtr;
+	BlitJob.DstRowBytes = dstRowBytes;
+	BlitJob.Width       = width;
+	BlitJob.Height      = height;
+	BlitJob.Scale       = scale;
+	BlitJob.NumBands    = scale ? (height + BLIT_BAND_LINES - 1) / BLIT_BAND_LINES : 1;
+	BlitJob.NextBand    = 0;
+	BlitJob.DoneBands   = 0;
+
+	pthread_cond_broadcast(&BlitWorkCond);
+	pthread_mutex_unlock(&BlitMutex);
+}
+
+#endif
+
+bool8 S9xBlitPipelineInit (int threads)
+{
+	S9xBlitPipelineDeinit();
+
+#ifdef USE_THREADS
+	if (threads <= 0)
+		threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads > BLIT_MAX_THREADS)
+		threads = BLIT_MAX_THREADS;
+
+	BlitQuit = FALSE;
+
+	for (BlitNumThreads = 0; BlitNumThreads < threads; BlitNumThreads++)
+	{
+		if (pthread_create(&BlitThreads[BlitNumThreads], NULL, S9xBlitWorker, NULL) != 0)
+			break;
+	}
+#endif
+
+	return (TRUE);
+}
+
+void S9xBlitPipelineDeinit (void)
+{
+	S9xBlitPipelineWait();
+
+#ifdef USE_THREADS
+	pthread_mutex_lock(&BlitMutex);
+	BlitQuit = TRUE;
+	pthread_cond_broadcast(&BlitWorkCond);
+	pthread_mutex_unlock(&BlitMutex);
+
+	for (int i = 0; i < BlitNumThreads; i++)
+		pthread_join(BlitThreads[i], NULL);
+
+	BlitNumThreads = 0;
+
+	if (BlitFrame)
+	{
+		free(BlitFrame);
+		BlitFrame = NULL;
+	}
+
+	BlitFrameSize = 0;
+#endif
+}
+
+// Filters the frame and returns when it is done. The calling thread works on bands too.
+
+void S9xBlitPipelineRun (BlitFunc blit, uint8 *srcPtr, int srcRowBytes, uint8 *dstPtr, int dstRowBytes, int width, int height)
+{
+	S9xBlitPipelineWait();
+
+#ifdef USE_THREADS
+	if (BlitNumThreads)
+	{
+		S9xBlitStartJob(blit, srcPtr, srcRowBytes, dstPtr, dstRowBytes, width, height);
+
+		pthread_mutex_lock(&BlitMutex);
+
+		while (BlitJob.NextBand < BlitJob.NumBands)
+		{
+			int	band = BlitJob.NextBand++;
+
+			pthread_mutex_unlock(&BlitMutex);
+			S9xBlitRunBand(&BlitJob, band);
+			pthread_mutex_lock(&BlitMutex);
+
+			++BlitJob.DoneBands;
+		}
+
+		while (BlitJob.DoneBands < BlitJob.NumBands)
+			pthread_cond_wait(&BlitDoneCond, &BlitMutex);
+
+		pthread_mutex_unlock(&BlitMutex);
+
+		return;
+	}
+#endif
+
+	blit(srcPtr, srcRowBytes, dstPtr, dstRowBytes, width, height);
+}
+
+// Copies the frame and starts filtering it in the background, so the next frame can be emulated meanwhile.
+// dstPtr must stay valid until S9xBlitPipelineWait() returns.
+
+bool8 S9xBlitPipelineSubmit (BlitFunc blit, uint8 *srcPtr, int srcRowBytes, uint8 *dstPtr, int dstRowBytes, int width, int height)
+{
+	S9xBlitPipelineWait();
+
+#ifdef USE_THREADS
+	if (BlitNumThreads)
+	{
+		// Filters peek at the lines just outside the frame, keep them blank.
+		int	size = (height + BLIT_MARGIN_LINES * 2) * srcRowBytes;
+
+		if (size > BlitFrameSize)
+		{
+			uint8	*frame = (uint8 *) realloc(BlitFrame, size);
+			if (!frame)
+				return (FALSE);
+
+			BlitFrame     = frame;
+			BlitFrameSize = size;
+		}
+
+		uint8	*src = BlitFrame + BLIT_MARGIN_LINES * srcRowBytes;
+
+		memset(BlitFrame, 0, BLIT_MARGIN_LINES * srcRowBytes);
+		memcpy(src, srcPtr, height * srcRowBytes);
+		memset(src + height * srcRowBytes, 0, BLIT_MARGIN_LINES * srcRowBytes);
+
+		S9xBlitStartJob(blit, src, srcRowBytes, dstPtr, dstRowBytes, width, height);
+		BlitFramePending = TRUE;
+
+		return (TRUE);
+	}
+#endif
+
+	blit(srcPtr, srcRowBytes, dstPtr, dstRowBytes, width, height);
+
+	return (TRUE);
+}
+
+void S9xBlitPipelineWait (void)
+{
+#ifdef USE_THREADS
+	if (!BlitFramePending)
+		return;
+
+	pthread_mutex_lock(&BlitMutex);
+	while (BlitJob.DoneBands < BlitJob.NumBands)
+		pthread_cond_wait(&BlitDoneCond, &BlitMutex);
+	pthread_mutex_unlock(&BlitMutex);
+
+	BlitFramePending = FALSE;
+#endif
+}
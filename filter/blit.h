@@ -183,6 +183,8 @@
 #include "hq2x.h"
 #include "snes_ntsc.h"
 
+typedef void (*BlitFunc) (uint8 *, int, uint8 *, int, int, int);
+
 bool8 S9xBlitFilterInit (void);
 void S9xBlitFilterDeinit (void);
 void S9xBlitClearDelta (void);
@@ -205,5 +207,10 @@ void S9xBlitPixHQ3x16 (uint8 *, int, uint8 *, int, int, int);
 void S9xBlitPixHQ4x16 (uint8 *, int, uint8 *, int, int, int);
 void S9xBlitPixNTSC16 (uint8 *, int, uint8 *, int, int, int);
 void S9xBlitPixHiResNTSC16 (uint8 *, int, uint8 *, int, int, int);
+bool8 S9xBlitPipelineInit (int);
+void S9xBlitPipelineDeinit (void);
+void S9xBlitPipelineRun (BlitFunc, uint8 *, int, uint8 *, int, int, int);
+bool8 S9xBlitPipelineSubmit (BlitFunc, uint8 *, int, uint8 *, int, int, int);
+void S9xBlitPipelineWait (void);
 
 #endif
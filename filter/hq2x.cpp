@@ -179,6 +179,11 @@
 #include "gfx.h"
 #include "hq2x.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define HQ_SIMD
+#endif
+
 #define	Ymask	0xFF0000
 #define	Umask	0x00FF00
 #define	Vmask	0x0000FF
@@ -186,6 +191,9 @@
 #define	trU		0x000700
 #define	trV		0x000006
 
+// SNES lines are never wider than this, the per-line buffers below are sized for it.
+#define HQ_MAX_WIDTH	(SNES_WIDTH * 2)
+
 #ifdef GFX_MULTI_FORMAT
 static uint16	Mask_2 = 0, Mask13 = 0;
 #else
@@ -506,6 +514,13 @@ static int	*RGBtoYUV = NULL;
 
 static void InitLUTs (void);
 static inline bool Diff (int, int);
+static void ComputePatterns (uint16 *, uint32, int, uint8 *);
+#ifdef HQ_SIMD
+static void ComputePatternsSSE2 (uint16 *, uint32, int, uint8 *);
+static void ComputePatternsAVX2 (uint16 *, uint32, int, uint8 *);
+#endif
+
+static void	(*HQComputePatterns) (uint16 *, uint32, int, uint8 *) = ComputePatterns;
 
 
 bool8 S9xBlitHQ2xFilterInit (void)
@@ -522,6 +537,12 @@ bool8 S9xBlitHQ2xFilterInit (void)
 
 	InitLUTs();
 
+#ifdef HQ_SIMD
+	HQComputePatterns = __builtin_cpu_supports("avx2") ? ComputePatternsAVX2 : ComputePatternsSSE2;
+#else
+	HQComputePatterns = ComputePatterns;
+#endif
+
 	return (TRUE);
 }
 
@@ -572,6 +593,146 @@ static inline bool Diff (int c1, int c2)
 	return (false);
 }
 
+// The 8-neighbour difference pattern only depends on the source, so it is worked out for a whole line
+// before the interpolation pass. Each source pixel is converted to YUV once per line instead of nine times.
+// Bit order is the one the HQnx switch tables expect: w1 w2 w3 w4 w6 w7 w8 w9.
+
+static inline void LookupYUV (uint16 *sp, int count, int *yuv)
+{
+	for (int i = 0; i < count; i++)
+		yuv[i] = RGBtoYUV[sp[i]];
+}
+
+static void ComputePatterns (uint16 *sp, uint32 src1line, int width, uint8 *pattern)
+{
+	int	yuv[3][HQ_MAX_WIDTH + 2];
+
+	LookupYUV(sp - src1line - 1, width + 2, yuv[0]);
+	LookupYUV(sp - 1,            width + 2, yuv[1]);
+	LookupYUV(sp + src1line - 1, width + 2, yuv[2]);
+
+	for (int x = 0; x < width; x++)
+	{
+		int		y = yuv[1][x + 1];
+		uint8	p = 0;
+
+		if (Diff(y, yuv[0][x    ])) p |= (1 << 0);
+		if (Diff(y, yuv[0][x + 1])) p |= (1 << 1);
+		if (Diff(y, yuv[0][x + 2])) p |= (1 << 2);
+		if (Diff(y, yuv[1][x    ])) p |= (1 << 3);
+		if (Diff(y, yuv[1][x + 2])) p |= (1 << 4);
+		if (Diff(y, yuv[2][x    ])) p |= (1 << 5);
+		if (Diff(y, yuv[2][x + 1])) p |= (1 << 6);
+		if (Diff(y, yuv[2][x + 2])) p |= (1 << 7);
+
+		pattern[x] = p;
+	}
+}
+
+#ifdef HQ_SIMD
+
+// Y, U and V sit in separate bytes, so Diff() becomes a per-byte absolute difference
+// followed by a saturating subtract of the thresholds: any non-zero byte means "different".
+
+#define DIFF_SSE2(n, bit) \
+	d = _mm_sub_epi8(_mm_max_epu8(c, (n)), _mm_min_epu8(c, (n))); \
+	d = _mm_cmpeq_epi32(_mm_subs_epu8(d, thresh), zero); \
+	p = _mm_or_si128(p, _mm_andnot_si128(d, _mm_set1_epi32(1 << (bit))))
+
+static void ComputePatternsSSE2 (uint16 *sp, uint32 src1line, int width, uint8 *pattern)
+{
+	int		yuv[3][HQ_MAX_WIDTH + 2 + 8];
+	__m128i	thresh = _mm_set1_epi32(trY | trU | trV);
+	__m128i	zero   = _mm_setzero_si128();
+
+	LookupYUV(sp - src1line - 1, width + 2, yuv[0]);
+	LookupYUV(sp - 1,            width + 2, yuv[1]);
+	LookupYUV(sp + src1line - 1, width + 2, yuv[2]);
+
+	for (int x = 0; x < width; x += 4)
+	{
+		__m128i	c = _mm_loadu_si128((__m128i *) &yuv[1][x + 1]);
+		__m128i	p = zero, d;
+		int		out;
+
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[0][x    ]), 0);
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[0][x + 1]), 1);
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[0][x + 2]), 2);
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[1][x    ]), 3);
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[1][x + 2]), 4);
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[2][x    ]), 5);
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[2][x + 1]), 6);
+		DIFF_SSE2(_mm_loadu_si128((__m128i *) &yuv[2][x + 2]), 7);
+
+		p = _mm_packs_epi32(p, p);
+		p = _mm_packus_epi16(p, p);
+		out = _mm_cvtsi128_si32(p);
+		memcpy(&pattern[x], &out, 4);
+	}
+}
+
+#undef DIFF_SSE2
+
+#define DIFF_AVX2(n, bit) \
+	d = _mm256_sub_epi8(_mm256_max_epu8(c, (n)), _mm256_min_epu8(c, (n))); \
+	d = _mm256_cmpeq_epi32(_mm256_subs_epu8(d, thresh), zero); \
+	p = _mm256_or_si256(p, _mm256_andnot_si256(d, _mm256_set1_epi32(1 << (bit))))
+
+__attribute__((target("avx2")))
+static void LookupYUVAVX2 (uint16 *sp, int count, int *yuv)
+{
+	int	i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i	idx = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i *) &sp[i]));
+		_mm256_storeu_si256((__m256i *) &yuv[i], _mm256_i32gather_epi32(RGBtoYUV, idx, 4));
+	}
+
+	for (; i < count; i++)
+		yuv[i] = RGBtoYUV[sp[i]];
+}
+
+__attribute__((target("avx2")))
+static void ComputePatternsAVX2 (uint16 *sp, uint32 src1line, int width, uint8 *pattern)
+{
+	int		yuv[3][HQ_MAX_WIDTH + 2 + 8];
+	__m256i	thresh = _mm256_set1_epi32(trY | trU | trV);
+	__m256i	zero   = _mm256_setzero_si256();
+
+	LookupYUVAVX2(sp - src1line - 1, width + 2, yuv[0]);
+	LookupYUVAVX2(sp - 1,            width + 2, yuv[1]);
+	LookupYUVAVX2(sp + src1line - 1, width + 2, yuv[2]);
+
+	for (int x = 0; x < width; x += 8)
+	{
+		__m256i	c = _mm256_loadu_si256((__m256i *) &yuv[1][x + 1]);
+		__m256i	p = zero, d;
+		int		out;
+
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[0][x    ]), 0);
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[0][x + 1]), 1);
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[0][x + 2]), 2);
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[1][x    ]), 3);
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[1][x + 2]), 4);
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[2][x    ]), 5);
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[2][x + 1]), 6);
+		DIFF_AVX2(_mm256_loadu_si256((__m256i *) &yuv[2][x + 2]), 7);
+
+		// packs work per 128-bit half, so each half ends up holding four patterns in its low dword
+		p = _mm256_packs_epi32(p, p);
+		p = _mm256_packus_epi16(p, p);
+		out = _mm_cvtsi128_si32(_mm256_castsi256_si128(p));
+		memcpy(&pattern[x], &out, 4);
+		out = _mm_cvtsi128_si32(_mm256_extracti128_si256(p, 1));
+		memcpy(&pattern[x + 4], &out, 4);
+	}
+}
+
+#undef DIFF_AVX2
+
+#endif
+
 void HQ2X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height)
 {
 	register int	w1, w2, w3, w4, w5, w6, w7, w8, w9;
@@ -581,7 +742,11 @@ void HQ2X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 	register uint16	*dp = (uint16 *) dstPtr;
 
 	uint32  pattern;
-	int		l, y;
+	uint8	patterns[HQ_MAX_WIDTH + 8], *pp;
+	int		l;
+
+	if (width > HQ_MAX_WIDTH)
+		width = HQ_MAX_WIDTH;
 
 	while (height--)
 	{
@@ -597,6 +762,9 @@ void HQ2X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 		w5 = *(sp);
 		w8 = *(sp + src1line);
 
+		HQComputePatterns(sp, src1line, width, patterns);
+		pp = patterns;
+
 		for (l = width; l; l--)
 		{
 			sp++;
@@ -605,17 +773,7 @@ void HQ2X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 			w6 = *(sp);
 			w9 = *(sp + src1line);
 
-			y = RGBtoYUV[w5];
-			pattern = 0;
-
-			if ((w1 != w5) && (Diff(y, RGBtoYUV[w1]))) pattern |= (1 << 0);
-			if ((w2 != w5) && (Diff(y, RGBtoYUV[w2]))) pattern |= (1 << 1);
-			if ((w3 != w5) && (Diff(y, RGBtoYUV[w3]))) pattern |= (1 << 2);
-			if ((w4 != w5) && (Diff(y, RGBtoYUV[w4]))) pattern |= (1 << 3);
-			if ((w6 != w5) && (Diff(y, RGBtoYUV[w6]))) pattern |= (1 << 4);
-			if ((w7 != w5) && (Diff(y, RGBtoYUV[w7]))) pattern |= (1 << 5);
-			if ((w8 != w5) && (Diff(y, RGBtoYUV[w8]))) pattern |= (1 << 6);
-			if ((w9 != w5) && (Diff(y, RGBtoYUV[w9]))) pattern |= (1 << 7);
+			pattern = *pp++;
 
 			switch (pattern)
 			{
@@ -3280,7 +3438,11 @@ void HQ3X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 	register uint16	*dp = (uint16 *) dstPtr;
 
 	uint32  pattern;
-	int		l, y;
+	uint8	patterns[HQ_MAX_WIDTH + 8], *pp;
+	int		l;
+
+	if (width > HQ_MAX_WIDTH)
+		width = HQ_MAX_WIDTH;
 
 	while (height--)
 	{
@@ -3296,6 +3458,9 @@ void HQ3X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 		w5 = *(sp);
 		w8 = *(sp + src1line);
 
+		HQComputePatterns(sp, src1line, width, patterns);
+		pp = patterns;
+
 		for (l = width; l; l--)
 		{
 			sp++;
@@ -3304,17 +3469,7 @@ void HQ3X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 			w6 = *(sp);
 			w9 = *(sp + src1line);
 
-			y = RGBtoYUV[w5];
-			pattern = 0;
-
-			if ((w1 != w5) && (Diff(y, RGBtoYUV[w1]))) pattern |= (1 << 0);
-			if ((w2 != w5) && (Diff(y, RGBtoYUV[w2]))) pattern |= (1 << 1);
-			if ((w3 != w5) && (Diff(y, RGBtoYUV[w3]))) pattern |= (1 << 2);
-			if ((w4 != w5) && (Diff(y, RGBtoYUV[w4]))) pattern |= (1 << 3);
-			if ((w6 != w5) && (Diff(y, RGBtoYUV[w6]))) pattern |= (1 << 4);
-			if ((w7 != w5) && (Diff(y, RGBtoYUV[w7]))) pattern |= (1 << 5);
-			if ((w8 != w5) && (Diff(y, RGBtoYUV[w8]))) pattern |= (1 << 6);
-			if ((w9 != w5) && (Diff(y, RGBtoYUV[w9]))) pattern |= (1 << 7);
+			pattern = *pp++;
 
 			switch (pattern)
 			{
@@ -6952,7 +7107,11 @@ void HQ4X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 	register uint16	*dp = (uint16 *) dstPtr;
 
 	uint32  pattern;
-	int		l, y;
+	uint8	patterns[HQ_MAX_WIDTH + 8], *pp;
+	int		l;
+
+	if (width > HQ_MAX_WIDTH)
+		width = HQ_MAX_WIDTH;
 
 	while (height--)
 	{
@@ -6968,6 +7127,9 @@ void HQ4X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 		w5 = *(sp);
 		w8 = *(sp + src1line);
 
+		HQComputePatterns(sp, src1line, width, patterns);
+		pp = patterns;
+
 		for (l = width; l; l--)
 		{
 			sp++;
@@ -6976,17 +7138,7 @@ void HQ4X_16 (uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 			w6 = *(sp);
 			w9 = *(sp + src1line);
 
-			y = RGBtoYUV[w5];
-			pattern = 0;
-
-			if ((w1 != w5) && (Diff(y, RGBtoYUV[w1]))) pattern |= (1 << 0);
-			if ((w2 != w5) && (Diff(y, RGBtoYUV[w2]))) pattern |= (1 << 1);
-			if ((w3 != w5) && (Diff(y, RGBtoYUV[w3]))) pattern |= (1 << 2);
-			if ((w4 != w5) && (Diff(y, RGBtoYUV[w4]))) pattern |= (1 << 3);
-			if ((w6 != w5) && (Diff(y, RGBtoYUV[w6]))) pattern |= (1 << 4);
-			if ((w7 != w5) && (Diff(y, RGBtoYUV[w7]))) pattern |= (1 << 5);
-			if ((w8 != w5) && (Diff(y, RGBtoYUV[w8]))) pattern |= (1 << 6);
-			if ((w9 != w5) && (Diff(y, RGBtoYUV[w9]))) pattern |= (1 << 7);
+			pattern = *pp++;
 
 			switch (pattern)
 			{
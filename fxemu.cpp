@@ -382,6 +382,9 @@ static void FxReset (struct FxInfo_s *psFxInfo)
 	// Start with a nop in the pipe
 	GSU.vPipe = 0x01;
 
+	// The ROM may have changed under the decoded instructions
+	fx_flushDecodeCache();
+
 	// Set pointer to GSU cache
 	GSU.pvCache = &GSU.pvRegisters[0x100];
 
@@ -199,6 +199,7 @@ void S9xInitSuperFX (void);
 void S9xSetSuperFX (uint8, uint16);
 uint8 S9xGetSuperFX (uint16);
 void fx_flushCache (void);
+void fx_flushDecodeCache (void);
 void fx_computeScreenPointers (void);
 uint32 fx_run (uint32);
 
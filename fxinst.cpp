@@ -874,13 +874,66 @@ static void fx_ldb_r11 (void)
 	FX_LDB(11);
 }
 
+#define FX_PLANE_LSBS	(((uint64) 0x01010101 << 32) | 0x01010101)
+#define FX_PLANE_GATHER	(((uint64) 0x01020408 << 32) | 0x10204080)
+
+// Writes the buffered row to the bitplanes. Bit p of each pixel's color is gathered into plane p's byte
+// with one multiply; only the pixels that were plotted are changed.
+void fx_flushPlotBuffer (void)
+{
+	uint8	*a = GSU.pvPlotRow;
+	uint8	m = (uint8) GSU.vPlotMask;
+	uint64	w = 0;
+
+	GSU.pvPlotRow = NULL;
+
+	for (int i = 0; i < 8; i++)
+		w = (w << 8) | GSU.avPlotColor[i];
+
+	for (uint32 p = 0; p < GSU.vPlotPlanes; p++)
+	{
+		uint8	bits = (uint8) ((((w >> p) & FX_PLANE_LSBS) * FX_PLANE_GATHER) >> 56);
+		uint8	*b = &a[((p >> 1) << 4) | (p & 1)];
+
+		*b = (*b & ~m) | (bits & m);
+	}
+}
+
+static inline void fx_bufferPlot (uint8 *a, uint32 x, uint8 c, uint32 planes)
+{
+	// Code or R14 reads from RAM could see the screen, don't hold pixels back then
+	if (GSU.vPrgBankReg - 0x70 < FX_RAM_BANKS || GSU.vRomBankReg - 0x70 < FX_RAM_BANKS)
+	{
+		GSU.pvPlotRow   = a;
+		GSU.vPlotMask   = 128 >> (x & 7);
+		GSU.vPlotPlanes = planes;
+		GSU.avPlotColor[x & 7] = c;
+		fx_flushPlotBuffer();
+		return;
+	}
+
+	if (GSU.pvPlotRow != a)
+	{
+		FX_FLUSH_PLOT;
+		GSU.pvPlotRow   = a;
+		GSU.vPlotMask   = 0;
+		GSU.vPlotPlanes = planes;
+	}
+
+	GSU.avPlotColor[x & 7] = c;
+	GSU.vPlotMask |= 128 >> (x & 7);
+
+	if (GSU.vPlotMask == 0xff)
+		fx_flushPlotBuffer();
+}
+
 // 4c - plot - plot pixel with R1, R2 as x, y and the color register as the color
 static void fx_plot_2bit (void)
 {
 	uint32	x = USEX8(R1);
 	uint32	y = USEX8(R2);
 	uint8	*a;
-	uint8	v, c;
+	uint8	c;
 
 	R15++;
 	CLRFLAGS;
@@ -900,17 +953,7 @@ static void fx_plot_2bit (void)
 		return;
 
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
-	v = 128 >> (x & 7);
-
-	if (c & 0x01)
-		a[0] |=  v;
-	else
-		a[0] &= ~v;
-
-	if (c & 0x02)
-		a[1] |=  v;
-	else
-		a[1] &= ~v;
+	fx_bufferPlot(a, x, c, 2);
 }
 
 // 4c (ALT1) - rpix - read color of the pixel with R1, R2 as x, y
@@ -929,6 +972,8 @@ static void fx_rpix_2bit (void)
 		return;
 #endif
 
+	FX_FLUSH_PLOT;
+
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
 	v = 128 >> (x & 7);
 
@@ -944,7 +989,7 @@ static void fx_plot_4bit (void)
 	uint32	x = USEX8(R1);
 	uint32	y = USEX8(R2);
 	uint8	*a;
-	uint8	v, c;
+	uint8	c;
 
 	R15++;
 	CLRFLAGS;
@@ -964,27 +1009,7 @@ static void fx_plot_4bit (void)
 		return;
 
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
-	v = 128 >> (x & 7);
-
-	if (c & 0x01)
-		a[0x00] |=  v;
-	else
-		a[0x00] &= ~v;
-
-	if (c & 0x02)
-		a[0x01] |=  v;
-	else
-		a[0x01] &= ~v;
-
-	if (c & 0x04)
-		a[0x10] |=  v;
-	else
-		a[0x10] &= ~v;
-
-	if (c & 0x08)
-		a[0x11] |=  v;
-	else
-		a[0x11] &= ~v;
+	fx_bufferPlot(a, x, c, 4);
 }
 
 // 4c (ALT1) - rpix - read color of the pixel with R1, R2 as x, y
@@ -1003,6 +1028,8 @@ static void fx_rpix_4bit (void)
 		return;
 #endif
 
+	FX_FLUSH_PLOT;
+
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
 	v = 128 >> (x & 7);
 
@@ -1020,7 +1047,7 @@ static void fx_plot_8bit (void)
 	uint32	x = USEX8(R1);
 	uint32	y = USEX8(R2);
 	uint8	*a;
-	uint8	v, c;
+	uint8	c;
 
 	R15++;
 	CLRFLAGS;
@@ -1042,47 +1069,7 @@ static void fx_plot_8bit (void)
 		return;
 
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
-	v = 128 >> (x & 7);
-
-	if (c & 0x01)
-		a[0x00] |=  v;
-	else
-		a[0x00] &= ~v;
-
-	if (c & 0x02)
-		a[0x01] |=  v;
-	else
-		a[0x01] &= ~v;
-
-	if (c & 0x04)
-		a[0x10] |=  v;
-	else
-		a[0x10] &= ~v;
-
-	if (c & 0x08)
-		a[0x11] |=  v;
-	else
-		a[0x11] &= ~v;
-
-	if (c & 0x10)
-		a[0x20] |=  v;
-	else
-		a[0x20] &= ~v;
-
-	if (c & 0x20)
-		a[0x21] |=  v;
-	else
-		a[0x21] &= ~v;
-
-	if (c & 0x40)
-		a[0x30] |=  v;
-	else
-		a[0x30] &= ~v;
-
-	if (c & 0x80)
-		a[0x31] |=  v;
-	else
-		a[0x31] &= ~v;
+	fx_bufferPlot(a, x, c, 8);
 }
 
 // 4c (ALT1) - rpix - read color of the pixel with R1, R2 as x, y
@@ -1101,6 +1088,8 @@ static void fx_rpix_8bit (void)
 		return;
 #endif
 
+	FX_FLUSH_PLOT;
+
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
 	v = 128 >> (x & 7);
 
@@ -2770,6 +2759,7 @@ static void fx_jmp_r13 (void)
 
 // 98-9d (ALT1) - ljmp rn - set program bank to source register and jump to address of register
 #define FX_LJMP(reg) \
+	FX_FLUSH_PLOT; \
 	GSU.vPrgBankReg = GSU.avReg[reg] & 0x7f; \
 	GSU.pvPrgBank = GSU.apvRomBank[GSU.vPrgBankReg]; \
 	R15 = SREG; \
@@ -3696,6 +3686,7 @@ static void fx_ramb (void)
 // df (ALT3) - romb - set current ROM bank
 static void fx_romb (void)
 {
+	FX_FLUSH_PLOT;
 	GSU.vRomBankReg = USEX8(SREG) & 0x7f;
 	GSU.pvRomBank = GSU.apvRomBank[GSU.vRomBankReg];
 	CLRFLAGS;
@@ -4132,6 +4123,115 @@ static void fx_sm_r15 (void)
 	FX_SM(15);
 }
 
+// Pre-decoded prefix chains
+// ALT1/ALT2/ALT3, TO, WITH and FROM only set up state for the instruction that follows them.
+// From the clean state CLRFLAGS leaves behind, a chain of them always ends up with the same ALT mode
+// and source/destination registers, so each chain is decoded once per ROM address and then run as
+// a single step. Code in GSU RAM may be rewritten at any time and is never decoded.
+
+#define FX_DECODE_ENTRIES	4096
+#define FX_DECODE_MAX_CHAIN	4
+
+#define FX_IS_PREFIX(op)	(((op) & 0xf0) == 0x10 || ((op) & 0xf0) == 0x20 || ((op) & 0xf0) == 0xb0 || ((op) >= 0x3d && (op) <= 0x3f))
+
+struct FxDecoded
+{
+	uint32	vTag;						// (PBR << 16) | R15 where the chain was found, ~0 if unused
+	uint16	vIndex;						// fx_OpcodeTable index of the instruction ending the chain
+	uint16	vStatus;					// ALT1, ALT2 and B as left by the chain
+	uint8	vFirst;						// first prefix, as it was found in the pipe
+	uint8	nPrefixes;					// 0 if the chain can't be run as one step
+	uint8	vSreg;
+	uint8	vDreg;
+};
+
+static struct FxDecoded	fx_DecodeCache[FX_DECODE_ENTRIES];
+
+void fx_flushDecodeCache (void)
+{
+	for (int i = 0; i < FX_DECODE_ENTRIES; i++)
+		fx_DecodeCache[i].vTag = ~0;
+}
+
+static void fx_decodeChain (struct FxDecoded *d, uint32 vTag)
+{
+	uint32	vStatus = 0, vSreg = 0, vDreg = 0, n = 0;
+	uint8	op = PIPE;
+
+	d->vTag      = vTag;
+	d->vFirst    = op;
+	d->nPrefixes = 0;
+
+	for (;;)
+	{
+		if (op >= 0x3d && op <= 0x3f)
+		{
+			vStatus &= ~FLG_B;
+			vStatus |= (op == 0x3d) ? FLG_ALT1 : (op == 0x3e) ? FLG_ALT2 : (FLG_ALT1 | FLG_ALT2);
+		}
+		else
+		if ((op & 0xf0) == 0x20)
+		{
+			vStatus |= FLG_B;
+			vSreg = vDreg = op & 0x0f;
+		}
+		else
+		if ((op & 0xf0) == 0x10 && !(vStatus & FLG_B))
+		{
+			// 'to r15' doesn't advance R15, leave it to the interpreter
+			if (op == 0x1f)
+				return;
+			vDreg = op & 0x0f;
+		}
+		else
+		if ((op & 0xf0) == 0xb0 && !(vStatus & FLG_B))
+			vSreg = op & 0x0f;
+		else
+			break;
+
+		if (++n > FX_DECODE_MAX_CHAIN)
+			return;
+
+		op = PRGBANK(R15 + n - 1);
+	}
+
+	d->vIndex    = (vStatus & (FLG_ALT1 | FLG_ALT2)) | op;
+	d->vStatus   = vStatus;
+	d->nPrefixes = n;
+	d->vSreg     = vSreg;
+	d->vDreg     = vDreg;
+}
+
+static inline bool8 fx_runDecoded (void)
+{
+	uint32				vTag;
+	struct FxDecoded	*d;
+
+	// running from GSU RAM
+	if (GSU.vPrgBankReg - 0x70 < FX_RAM_BANKS)
+		return (FALSE);
+
+	vTag = (GSU.vPrgBankReg << 16) | USEX16(R15);
+	d = &fx_DecodeCache[(USEX16(R15) ^ (GSU.vPrgBankReg << 5)) & (FX_DECODE_ENTRIES - 1)];
+
+	if (d->vTag != vTag || d->vFirst != PIPE)
+		fx_decodeChain(d, vTag);
+
+	// the prefixes count as instructions, don't let the chain cross the end of the time slice
+	if (!d->nPrefixes || GSU.vCounter < d->nPrefixes)
+		return (FALSE);
+
+	GSU.vCounter   -= d->nPrefixes;
+	GSU.vStatusReg |= d->vStatus;
+	GSU.pvSreg = &GSU.avReg[d->vSreg];
+	GSU.pvDreg = &GSU.avReg[d->vDreg];
+	R15 += d->nPrefixes;
+	FETCHPIPE;
+	(*fx_OpcodeTable[d->vIndex])();
+
+	return (TRUE);
+}
+
 // GSU executions functions
 
 uint32 fx_run (uint32 nInstructions)
@@ -4139,7 +4239,14 @@ uint32 fx_run (uint32 nInstructions)
 	GSU.vCounter = nInstructions;
 	READR14;
 	while (TF(G) && (GSU.vCounter-- > 0))
+	{
+		if (FX_IS_PREFIX(PIPE) && !(GSU.vStatusReg & (FLG_ALT1 | FLG_ALT2 | FLG_B)) && GSU.pvSreg == &R0 && GSU.pvDreg == &R0 && fx_runDecoded())
+			continue;
+
 		FX_STEP;
+	}
+
+	FX_FLUSH_PLOT;
 #if 0
 #ifndef FX_ADDRESS_CHECK
 	GSU.vPipeAdr = USEX16(R15 - 1) | (USEX8(GSU.vPrgBankReg) << 16);
@@ -358,6 +358,13 @@ struct FxRegs_s
 	void	(*pfPlot) (void);
 	void	(*pfRpix) (void);
 
+	// Plot buffer, like the GSU's own: pixels plotted into one 8-pixel row are collected
+	// and written to the bitplanes together
+	uint8	*pvPlotRow;					// Plane 0 byte of the buffered row, NULL if empty
+	uint32	vPlotMask;					// Buffered pixels, 0x80 is the leftmost
+	uint32	vPlotPlanes;				// Bitplanes in the current mode
+	uint8	avPlotColor[8];				// Buffered colors
+
 	uint8	*pvRamBank;					// Pointer to current RAM-bank
 	uint8	*pvRomBank;					// Pointer to current ROM-bank
 	uint8	*pvPrgBank;					// Pointer to current program ROM-bank
@@ -450,8 +457,11 @@ extern struct FxRegs_s	GSU;
 // Clear flags
 #define CLRFLAGS		GSU.vStatusReg &= ~(FLG_ALT1 | FLG_ALT2 | FLG_B); GSU.pvDreg = GSU.pvSreg = &R0
 
+// Write out buffered plots before anything else touches RAM
+#define FX_FLUSH_PLOT	if (GSU.pvPlotRow) fx_flushPlotBuffer()
+
 // Read current RAM-Bank
-#define RAM(adr)		GSU.pvRamBank[USEX16(adr)]
+#define RAM(adr)		(*fx_ramAddress(adr))
 
 // Read current ROM-Bank
 #define ROM(idx)		GSU.pvRomBank[USEX16(idx)]
@@ -538,6 +548,14 @@ extern struct FxRegs_s	GSU;
 extern void (*fx_PlotTable[]) (void);
 extern void (*fx_OpcodeTable[]) (void);
 
+void fx_flushPlotBuffer (void);
+
+static inline uint8 * fx_ramAddress (uint32 adr)
+{
+	FX_FLUSH_PLOT;
+	return (&GSU.pvRamBank[USEX16(adr)]);
+}
+
 // Set this define if branches are relative to the instruction in the delay slot (I think they are)
 #define BRANCH_DELAY_RELATIVE
 
@@ -247,6 +247,8 @@ inline uint8 S9xGetByte (uint32 Address)
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
+		S9xSA1SyncAddress(Address);
+
 	#ifdef CPU_SHUTDOWN
 		if (Memory.BlockIsRAM[block])
 			CPU.WaitAddress = CPU.PBPCAtOpcodeStart;
@@ -293,6 +295,7 @@ inline uint8 S9xGetByte (uint32 Address)
 			return (byte);
 
 		case CMemory::MAP_BWRAM:
+			S9xSA1Sync();
 			byte = *(Memory.BWRAM + ((Address & 0x7fff) - 0x6000));
 			addCyclesInMemoryAccess;
 			return (byte);
@@ -379,6 +382,8 @@ inline uint16 S9xGetWord (uint32 Address, enum s9xwrap_t w = WRAP_NONE)
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
+		S9xSA1SyncAddress(Address);
+
 	#ifdef CPU_SHUTDOWN
 		if (Memory.BlockIsRAM[block])
 			CPU.WaitAddress = CPU.PBPCAtOpcodeStart;
@@ -440,6 +445,7 @@ inline uint16 S9xGetWord (uint32 Address, enum s9xwrap_t w = WRAP_NONE)
 			return (word);
 
 		case CMemory::MAP_BWRAM:
+			S9xSA1Sync();
 			word = READ_WORD(Memory.BWRAM + ((Address & 0x7fff) - 0x6000));
 			addCyclesInMemoryAccess_x2;
 			return (word);
@@ -520,6 +526,8 @@ inline void S9xSetByte (uint8 Byte, uint32 Address)
 
 	if (SetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
+		S9xSA1SyncAddress(Address);
+
 	#ifdef CPU_SHUTDOWN
 		SetAddress += (Address & 0xffff);
 		*SetAddress = Byte;
@@ -586,6 +594,7 @@ inline void S9xSetByte (uint8 Byte, uint32 Address)
 			return;
 
 		case CMemory::MAP_BWRAM:
+			S9xSA1Sync();
 			*(Memory.BWRAM + ((Address & 0x7fff) - 0x6000)) = Byte;
 			CPU.SRAMModified = TRUE;
 			addCyclesInMemoryAccess;
@@ -680,6 +689,8 @@ inline void S9xSetWord (uint16 Word, uint32 Address, enum s9xwrap_t w = WRAP_NON
 
 	if (SetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
+		S9xSA1SyncAddress(Address);
+
 	#ifdef CPU_SHUTDOWN
 		SetAddress += (Address & 0xffff);
 		WRITE_WORD(SetAddress, Word);
@@ -799,6 +810,7 @@ inline void S9xSetWord (uint16 Word, uint32 Address, enum s9xwrap_t w = WRAP_NON
 			return;
 
 		case CMemory::MAP_BWRAM:
+			S9xSA1Sync();
 			WRITE_WORD(Memory.BWRAM + ((Address & 0x7fff) - 0x6000), Word);
 			CPU.SRAMModified = TRUE;
 			addCyclesInMemoryAccess_x2;
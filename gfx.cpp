@@ -207,7 +207,7 @@ static void DrawBackgroundOffsetMosaic (int, uint8, uint8, int);
 static inline void DrawBackgroundMode7 (int, void (*DrawMath) (uint32, uint32, int), void (*DrawNomath) (uint32, uint32, int), int);
 static inline void DrawBackdrop (void);
 static inline void RenderScreen (bool8);
-static uint16 get_crosshair_color (uint8);
+static pixel_t get_crosshair_color (uint8);
 
 #define TILE_PLUS(t, x)	(((t) & 0xfc00) | ((t + x) & 0x3ff))
 
@@ -215,7 +215,7 @@ static uint16 get_crosshair_color (uint8);
 bool8 S9xGraphicsInit (void)
 {
 	S9xInitTileRenderer();
-	ZeroMemory(BlackColourMap, 256 * sizeof(uint16));
+	ZeroMemory(BlackColourMap, 256 * sizeof(pixel_t));
 
 #ifdef GFX_MULTI_FORMAT
 	if (GFX.BuildPixel == NULL)
@@ -224,21 +224,29 @@ bool8 S9xGraphicsInit (void)
 
 	GFX.DoInterlace = 0;
 	GFX.InterlaceFrame = 0;
-	GFX.RealPPL = GFX.Pitch >> 1;
+	GFX.RealPPL = GFX.Pitch / sizeof(pixel_t);
 	IPPU.OBJChanged = TRUE;
 	IPPU.DirectColourMapsNeedRebuild = TRUE;
 	Settings.BG_Forced = 0;
 	S9xFixColourBrightness();
 
+	GFX.ScreenSize = GFX.Pitch / sizeof(pixel_t) * SNES_HEIGHT_EXTENDED * (Settings.SupportHiRes ? 2 : 1);
+	GFX.SubScreen  = (pixel_t *) malloc(GFX.ScreenSize * sizeof(pixel_t));
+	GFX.ZBuffer    = (uint8 *)   malloc(GFX.ScreenSize);
+	GFX.SubZBuffer = (uint8 *)   malloc(GFX.ScreenSize);
+
+	if (!GFX.SubScreen || !GFX.ZBuffer || !GFX.SubZBuffer)
+	{
+		S9xGraphicsDeinit();
+		return (FALSE);
+	}
+
+#ifndef GFX_XRGB8888
+	// XRGB8888 does colour math arithmetically, see COLOR_ADD/COLOR_SUB in gfx.h
 	GFX.X2   = (uint16 *) malloc(sizeof(uint16) * 0x10000);
 	GFX.ZERO = (uint16 *) malloc(sizeof(uint16) * 0x10000);
 
-	GFX.ScreenSize = GFX.Pitch / 2 * SNES_HEIGHT_EXTENDED * (Settings.SupportHiRes ? 2 : 1);
-	GFX.SubScreen  = (uint16 *) malloc(GFX.ScreenSize * sizeof(uint16));
-	GFX.ZBuffer    = (uint8 *)  malloc(GFX.ScreenSize);
-	GFX.SubZBuffer = (uint8 *)  malloc(GFX.ScreenSize);
-
-	if (!GFX.X2 || !GFX.ZERO || !GFX.SubScreen || !GFX.ZBuffer || !GFX.SubZBuffer)
+	if (!GFX.X2 || !GFX.ZERO)
 	{
 		S9xGraphicsDeinit();
 		return (FALSE);
@@ -301,6 +309,7 @@ bool8 S9xGraphicsInit (void)
 			}
 		}
 	}
+#endif
 
 	return (TRUE);
 }
@@ -354,7 +363,7 @@ void S9xStartScreenRefresh (void)
 
 			if (Settings.SupportHiRes && (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires || IPPU.Interlace || IPPU.InterlaceOBJ))
 			{
-				GFX.RealPPL = GFX.Pitch >> 1;
+				GFX.RealPPL = GFX.Pitch / sizeof(pixel_t);
 				IPPU.DoubleWidthPixels = TRUE;
 				IPPU.RenderedScreenWidth = SNES_WIDTH << 1;
 				if (IPPU.Interlace || IPPU.InterlaceOBJ)
@@ -382,7 +391,7 @@ void S9xStartScreenRefresh (void)
 					GFX.RealPPL = GFX.PPL = SNES_WIDTH;
 				else
 			#endif
-					GFX.RealPPL = GFX.PPL = GFX.Pitch >> 1;
+					GFX.RealPPL = GFX.PPL = GFX.Pitch / sizeof(pixel_t);
 			}
 
 			IPPU.RenderedFramesCount++;
@@ -683,18 +692,18 @@ void S9xUpdateScreen (void)
 					// Have to back out of the speed up hack where the low res.
 					// SNES image was rendered into a 256x239 sized buffer,
 					// ignoring the true, larger size of the buffer.
-					GFX.RealPPL = GFX.Pitch >> 1;
+					GFX.RealPPL = GFX.Pitch / sizeof(pixel_t);
 
 					for (register int32 y = (int32) GFX.StartY - 1; y >= 0; y--)
 					{
-						register uint16	*p = GFX.Screen + y * GFX.PPL     + 255;
-						register uint16	*q = GFX.Screen + y * GFX.RealPPL + 510;
+						register pixel_t	*p = GFX.Screen + y * GFX.PPL     + 255;
+						register pixel_t	*q = GFX.Screen + y * GFX.RealPPL + 510;
 
 						for (register int x = 255; x >= 0; x--, p--, q -= 2)
 							*q = *(q + 1) = *p;
 					}
 
-					GFX.PPL = GFX.RealPPL; // = GFX.Pitch >> 1 above
+					GFX.PPL = GFX.RealPPL; // = GFX.Pitch / sizeof(pixel_t) above
 				}
 				else
 			#endif
@@ -702,8 +711,8 @@ void S9xUpdateScreen (void)
 					// Have to back out of the regular speed hack
 					for (register uint32 y = 0; y < GFX.StartY; y++)
 					{
-						register uint16	*p = GFX.Screen + y * GFX.PPL + 255;
-						register uint16	*q = GFX.Screen + y * GFX.PPL + 510;
+						register pixel_t	*p = GFX.Screen + y * GFX.PPL + 255;
+						register pixel_t	*q = GFX.Screen + y * GFX.PPL + 510;
 
 						for (register int x = 255; x >= 0; x--, p--, q -= 2)
 							*q = *(q + 1) = *p;
@@ -722,7 +731,7 @@ void S9xUpdateScreen (void)
 				GFX.DoInterlace = 2;
 
 				for (register int32 y = (int32) GFX.StartY - 1; y >= 0; y--)
-					memmove(GFX.Screen + y * GFX.PPL, GFX.Screen + y * GFX.RealPPL, IPPU.RenderedScreenWidth * sizeof(uint16));
+					memmove(GFX.Screen + y * GFX.PPL, GFX.Screen + y * GFX.RealPPL, IPPU.RenderedScreenWidth * sizeof(pixel_t));
 			}
 		}
 
@@ -739,7 +748,7 @@ void S9xUpdateScreen (void)
 	}
 	else
 	{
-		const uint16	black = BUILD_PIXEL(0, 0, 0);
+		const pixel_t	black = BUILD_PIXEL(0, 0, 0);
 
 		GFX.S = GFX.Screen + GFX.StartY * GFX.PPL;
 		if (GFX.DoInterlace && GFX.InterlaceFrame)
@@ -1955,9 +1964,9 @@ void S9xSetInfoString (const char *string)
 	}
 }
 
-void S9xDisplayChar (uint16 *s, uint8 c)
+void S9xDisplayChar (pixel_t *s, uint8 c)
 {
-	const uint16	black = BUILD_PIXEL(0, 0, 0);
+	const pixel_t	black = BUILD_PIXEL(0, 0, 0);
 
 	int	line   = ((c - 32) >> 4) * font_height;
 	int	offset = ((c - 32) & 15) * font_width;
@@ -1982,7 +1991,7 @@ static void DisplayStringFromBottom (const char *string, int linesFromBottom, in
 	if (linesFromBottom <= 0)
 		linesFromBottom = 1;
 
-	uint16	*dst = GFX.Screen + (IPPU.RenderedScreenHeight - font_height * linesFromBottom) * GFX.RealPPL + pixelsFromLeft;
+	pixel_t	*dst = GFX.Screen + (IPPU.RenderedScreenHeight - font_height * linesFromBottom) * GFX.RealPPL + pixelsFromLeft;
 
 	int	len = strlen(string);
 	int	max_chars = IPPU.RenderedScreenWidth / (font_width - 1);
@@ -2183,7 +2192,7 @@ static void DisplayWatchedAddresses (void)
 	}
 }
 
-void S9xDisplayMessages (uint16 *screen, int ppl, int width, int height, int scale)
+void S9xDisplayMessages (pixel_t *screen, int ppl, int width, int height, int scale)
 {
 	if (Settings.DisplayFrameRate)
 		DisplayFrameRate();
@@ -2201,26 +2210,26 @@ void S9xDisplayMessages (uint16 *screen, int ppl, int width, int height, int sca
 		S9xDisplayString(GFX.InfoString, 5, 1, true);
 }
 
-static uint16 get_crosshair_color (uint8 color)
+static pixel_t get_crosshair_color (uint8 color)
 {
 	switch (color & 15)
 	{
-		case  0: return (BUILD_PIXEL( 0,  0,  0)); // transparent, shouldn't be used
-		case  1: return (BUILD_PIXEL( 0,  0,  0)); // Black
-		case  2: return (BUILD_PIXEL( 8,  8,  8)); // 25Grey
-		case  3: return (BUILD_PIXEL(16, 16, 16)); // 50Grey
-		case  4: return (BUILD_PIXEL(23, 23, 23)); // 75Grey
-		case  5: return (BUILD_PIXEL(31, 31, 31)); // White
-		case  6: return (BUILD_PIXEL(31,  0,  0)); // Red
-		case  7: return (BUILD_PIXEL(31, 16,  0)); // Orange
-		case  8: return (BUILD_PIXEL(31, 31,  0)); // Yellow
-		case  9: return (BUILD_PIXEL( 0, 31,  0)); // Green
-		case 10: return (BUILD_PIXEL( 0, 31, 31)); // Cyan
-		case 11: return (BUILD_PIXEL( 0, 23, 31)); // Sky
-		case 12: return (BUILD_PIXEL( 0,  0, 31)); // Blue
-		case 13: return (BUILD_PIXEL(23,  0, 31)); // Violet
-		case 14: return (BUILD_PIXEL(31,  0, 31)); // Magenta
-		case 15: return (BUILD_PIXEL(31,  0, 16)); // Purple
+		case  0: return (BUILD_PIXEL5( 0,  0,  0)); // transparent, shouldn't be used
+		case  1: return (BUILD_PIXEL5( 0,  0,  0)); // Black
+		case  2: return (BUILD_PIXEL5( 8,  8,  8)); // 25Grey
+		case  3: return (BUILD_PIXEL5(16, 16, 16)); // 50Grey
+		case  4: return (BUILD_PIXEL5(23, 23, 23)); // 75Grey
+		case  5: return (BUILD_PIXEL5(31, 31, 31)); // White
+		case  6: return (BUILD_PIXEL5(31,  0,  0)); // Red
+		case  7: return (BUILD_PIXEL5(31, 16,  0)); // Orange
+		case  8: return (BUILD_PIXEL5(31, 31,  0)); // Yellow
+		case  9: return (BUILD_PIXEL5( 0, 31,  0)); // Green
+		case 10: return (BUILD_PIXEL5( 0, 31, 31)); // Cyan
+		case 11: return (BUILD_PIXEL5( 0, 23, 31)); // Sky
+		case 12: return (BUILD_PIXEL5( 0,  0, 31)); // Blue
+		case 13: return (BUILD_PIXEL5(23,  0, 31)); // Violet
+		case 14: return (BUILD_PIXEL5(31,  0, 31)); // Magenta
+		case 15: return (BUILD_PIXEL5(31,  0, 16)); // Purple
 	}
 
 	return (0);
@@ -2232,7 +2241,7 @@ void S9xDrawCrosshair (const char *crosshair, uint8 fgcolor, uint8 bgcolor, int1
 		return;
 
 	int16	r, rx = 1, c, cx = 1, W = SNES_WIDTH, H = PPU.ScreenHeight;
-	uint16	fg, bg;
+	pixel_t	fg, bg;
 
 	x -= 7;
 	y -= 7;
@@ -2248,7 +2257,7 @@ void S9xDrawCrosshair (const char *crosshair, uint8 fgcolor, uint8 bgcolor, int1
 	if (x >= 0 && y >= 0)
 #endif
 	{
-		uint16	*s = GFX.Screen + y * GFX.RealPPL + x;
+		pixel_t	*s = GFX.Screen + y * GFX.RealPPL + x;
 
 		for (r = 0; r < 15 * rx; r++, s += GFX.RealPPL - 15 * cx)
 		{
@@ -180,21 +180,21 @@
 
 struct SGFX
 {
-	uint16	*Screen;
-	uint16	*SubScreen;
+	pixel_t	*Screen;
+	pixel_t	*SubScreen;
 	uint8	*ZBuffer;
 	uint8	*SubZBuffer;
 	uint32	Pitch;
 	uint32	ScreenSize;
-	uint16	*S;
+	pixel_t	*S;
 	uint8	*DB;
 	uint16	*X2;
 	uint16	*ZERO;
 	uint32	RealPPL;			// true PPL of Screen buffer
 	uint32	PPL;				// number of pixels on each of Screen buffer
 	uint32	LinesPerTile;		// number of lines in 1 tile (4 or 8 due to interlace)
-	uint16	*ScreenColors;		// screen colors for rendering main
-	uint16	*RealScreenColors;	// screen colors, ignoring color window clipping
+	pixel_t	*ScreenColors;		// screen colors for rendering main
+	pixel_t	*RealScreenColors;	// screen colors, ignoring color window clipping
 	uint8	Z1;					// depth for comparison
 	uint8	Z2;					// depth to save
 	uint32	FixedColour;
@@ -265,10 +265,8 @@ struct SBG
 	uint8	EnableMath;
 	uint8	InterlaceLine;
 
-	uint8	*Buffer;
-	uint8	*BufferFlip;
-	uint8	*Buffered;
-	uint8	*BufferedFlip;
+	uint8	TileType;
+	uint8	TileTypeFlip;
 	bool8	DirectColourMode;
 };
 
@@ -293,8 +291,8 @@ struct SLineMatrixData
 	short	M7VOFS;
 };
 
-extern uint16		BlackColourMap[256];
-extern uint16		DirectColourMaps[8][256];
+extern pixel_t		BlackColourMap[256];
+extern pixel_t		DirectColourMaps[8][256];
 extern uint8		mul_brightness[16][32];
 extern struct SBG	BG;
 extern struct SGFX	GFX;
@@ -308,6 +306,38 @@ extern struct SGFX	GFX;
 	((C2) & RGB_REMOVE_LOW_BITS_MASK)) >> 1) + \
 	((C1) & (C2) & RGB_LOW_BITS_MASK)) | ALPHA_BITS_MASK)
 
+#ifdef GFX_XRGB8888
+
+// 8-bit channels leave no spare bits between them and are too wide for the X2/ZERO
+// lookup tables, so red/blue and green are processed as separate lanes instead.
+
+inline uint32 COLOR_ADD (uint32 C1, uint32 C2)
+{
+	uint32	rb = (C1 & 0xff00ff) + (C2 & 0xff00ff);
+	uint32	g  = (C1 & 0x00ff00) + (C2 & 0x00ff00);
+
+	rb |= ((rb & 0x1000100) >> 8) * 0xff;
+	g  |= ((g  & 0x0010000) >> 8) * 0xff;
+
+	return ((rb & 0xff00ff) | (g & 0x00ff00));
+}
+
+inline uint32 COLOR_SUB (uint32 C1, uint32 C2)
+{
+	uint32	rb = ((C1 & 0xff00ff) | 0x1000100) - (C2 & 0xff00ff);
+	uint32	g  = ((C1 & 0x00ff00) | 0x0010000) - (C2 & 0x00ff00);
+
+	rb &= ((rb & 0x1000100) >> 8) * 0xff;
+	g  &= ((g  & 0x0010000) >> 8) * 0xff;
+
+	return ((rb & 0xff00ff) | (g & 0x00ff00));
+}
+
+#define COLOR_SUB1_2(C1, C2) \
+	((COLOR_SUB((C1), (C2)) >> 1) & 0x7f7f7f)
+
+#else
+
 #define COLOR_ADD(C1, C2) \
 	(GFX.X2[((((C1) & RGB_REMOVE_LOW_BITS_MASK) + \
 	((C2) & RGB_REMOVE_LOW_BITS_MASK)) >> 1) + \
@@ -337,15 +367,18 @@ inline uint16 COLOR_SUB (uint16 C1, uint16 C2)
 	return (v);
 }
 
+#endif
+
 void S9xStartScreenRefresh (void);
 void S9xEndScreenRefresh (void);
 void S9xUpdateScreen (void);
 void S9xBuildDirectColourMaps (void);
 void RenderLine (uint8);
 void S9xComputeClipWindows (void);
-void S9xDisplayChar (uint16 *, uint8);
+void S9xResetClipCache (void);
+void S9xDisplayChar (pixel_t *, uint8);
 // called automatically unless Settings.AutoDisplayMessages is false
-void S9xDisplayMessages (uint16 *, int, int, int, int);
+void S9xDisplayMessages (pixel_t *, int, int, int, int);
 #ifdef GFX_MULTI_FORMAT
 bool8 S9xSetRenderPixelFormat (int);
 #endif
@@ -207,6 +207,9 @@ struct SDSP1			DSP1;
 struct SDSP2			DSP2;
 struct SDSP3			DSP3;
 struct SDSP4			DSP4;
+#ifdef DSP_PROFILE
+struct SDSPProfile		DSPProfile;
+#endif
 struct SSA1				SA1;
 struct SSA1Registers	SA1Registers;
 struct SST010			ST010;
@@ -237,8 +240,8 @@ CMemory					Memory;
 char	String[513];
 uint8	OpenBus = 0;
 uint8	*HDMAMemPointers[8];
-uint16	BlackColourMap[256];
-uint16	DirectColourMaps[8][256];
+pixel_t	BlackColourMap[256];
+pixel_t	DirectColourMaps[8][256];
 
 SnesModel	M1SNES = { 1, 3, 2 };
 SnesModel	M2SNES = { 2, 4, 3 };
@@ -289,6 +292,44 @@ int HDMA_ModeByteCounts[8] =
 	1, 2, 2, 4, 4, 4, 2, 4
 };
 
+#ifdef GFX_XRGB8888
+// 5-bit colour times brightness, expanded to 8 bits per channel
+uint8 mul_brightness[16][32] =
+{
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x00, 0x01, 0x01, 0x02, 0x02, 0x03, 0x03, 0x04, 0x04, 0x05, 0x05, 0x06, 0x07, 0x07, 0x08, 0x08,
+	  0x09, 0x09, 0x0a, 0x0a, 0x0b, 0x0c, 0x0c, 0x0d, 0x0d, 0x0e, 0x0e, 0x0f, 0x0f, 0x10, 0x10, 0x11 },
+	{ 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+	  0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22 },
+	{ 0x00, 0x02, 0x03, 0x05, 0x07, 0x08, 0x0a, 0x0b, 0x0d, 0x0f, 0x10, 0x12, 0x14, 0x15, 0x17, 0x19,
+	  0x1a, 0x1c, 0x1e, 0x1f, 0x21, 0x23, 0x24, 0x26, 0x28, 0x29, 0x2b, 0x2c, 0x2e, 0x30, 0x31, 0x33 },
+	{ 0x00, 0x02, 0x04, 0x06, 0x09, 0x0b, 0x0d, 0x0f, 0x12, 0x14, 0x16, 0x18, 0x1a, 0x1d, 0x1f, 0x21,
+	  0x23, 0x25, 0x27, 0x2a, 0x2c, 0x2e, 0x30, 0x32, 0x35, 0x37, 0x39, 0x3b, 0x3e, 0x40, 0x42, 0x44 },
+	{ 0x00, 0x03, 0x05, 0x08, 0x0b, 0x0e, 0x10, 0x13, 0x16, 0x19, 0x1b, 0x1e, 0x21, 0x24, 0x26, 0x29,
+	  0x2c, 0x2f, 0x31, 0x34, 0x37, 0x3a, 0x3c, 0x3f, 0x42, 0x45, 0x47, 0x4a, 0x4d, 0x50, 0x52, 0x55 },
+	{ 0x00, 0x03, 0x06, 0x0a, 0x0d, 0x10, 0x14, 0x17, 0x1a, 0x1e, 0x21, 0x24, 0x28, 0x2b, 0x2e, 0x31,
+	  0x35, 0x38, 0x3b, 0x3e, 0x42, 0x45, 0x48, 0x4c, 0x4f, 0x52, 0x56, 0x59, 0x5c, 0x60, 0x63, 0x66 },
+	{ 0x00, 0x04, 0x07, 0x0b, 0x0f, 0x13, 0x17, 0x1b, 0x1f, 0x23, 0x26, 0x2a, 0x2e, 0x32, 0x36, 0x39,
+	  0x3e, 0x41, 0x45, 0x49, 0x4d, 0x51, 0x54, 0x58, 0x5c, 0x60, 0x64, 0x68, 0x6c, 0x70, 0x73, 0x77 },
+	{ 0x00, 0x04, 0x09, 0x0d, 0x12, 0x16, 0x1a, 0x1e, 0x23, 0x27, 0x2c, 0x30, 0x35, 0x39, 0x3d, 0x42,
+	  0x46, 0x4b, 0x4f, 0x53, 0x58, 0x5c, 0x61, 0x65, 0x6a, 0x6e, 0x72, 0x76, 0x7b, 0x7f, 0x84, 0x88 },
+	{ 0x00, 0x05, 0x0a, 0x0e, 0x14, 0x19, 0x1d, 0x22, 0x28, 0x2c, 0x31, 0x36, 0x3b, 0x40, 0x45, 0x4a,
+	  0x4f, 0x54, 0x59, 0x5e, 0x63, 0x68, 0x6d, 0x71, 0x77, 0x7c, 0x80, 0x85, 0x8b, 0x8f, 0x94, 0x99 },
+	{ 0x00, 0x05, 0x0b, 0x10, 0x16, 0x1b, 0x21, 0x26, 0x2c, 0x31, 0x37, 0x3c, 0x42, 0x47, 0x4d, 0x52,
+	  0x58, 0x5d, 0x63, 0x68, 0x6e, 0x73, 0x79, 0x7e, 0x84, 0x89, 0x8f, 0x94, 0x9a, 0x9f, 0xa5, 0xaa },
+	{ 0x00, 0x06, 0x0c, 0x12, 0x18, 0x1e, 0x24, 0x2a, 0x30, 0x36, 0x3c, 0x42, 0x49, 0x4e, 0x54, 0x5a,
+	  0x61, 0x67, 0x6d, 0x72, 0x79, 0x7f, 0x85, 0x8b, 0x91, 0x97, 0x9d, 0xa3, 0xa9, 0xaf, 0xb5, 0xbb },
+	{ 0x00, 0x06, 0x0d, 0x13, 0x1a, 0x21, 0x27, 0x2e, 0x35, 0x3b, 0x42, 0x48, 0x4f, 0x56, 0x5c, 0x62,
+	  0x6a, 0x70, 0x76, 0x7d, 0x84, 0x8a, 0x91, 0x97, 0x9e, 0xa5, 0xab, 0xb2, 0xb9, 0xbf, 0xc6, 0xcc },
+	{ 0x00, 0x07, 0x0e, 0x15, 0x1d, 0x24, 0x2a, 0x31, 0x39, 0x40, 0x47, 0x4e, 0x56, 0x5d, 0x64, 0x6b,
+	  0x72, 0x79, 0x80, 0x87, 0x8f, 0x96, 0x9d, 0xa4, 0xac, 0xb3, 0xb9, 0xc0, 0xc8, 0xcf, 0xd6, 0xdd },
+	{ 0x00, 0x07, 0x0f, 0x16, 0x1f, 0x26, 0x2e, 0x35, 0x3e, 0x45, 0x4d, 0x54, 0x5c, 0x64, 0x6b, 0x73,
+	  0x7b, 0x83, 0x8a, 0x92, 0x9a, 0xa1, 0xa9, 0xb0, 0xb9, 0xc0, 0xc8, 0xcf, 0xd8, 0xdf, 0xe7, 0xee },
+	{ 0x00, 0x08, 0x10, 0x18, 0x21, 0x29, 0x31, 0x39, 0x42, 0x4a, 0x52, 0x5a, 0x63, 0x6b, 0x73, 0x7b,
+	  0x84, 0x8c, 0x94, 0x9c, 0xa5, 0xad, 0xb5, 0xbd, 0xc6, 0xce, 0xd6, 0xde, 0xe7, 0xef, 0xf7, 0xff }
+};
+#else
 uint8 mul_brightness[16][32] =
 {
 	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -324,6 +365,7 @@ uint8 mul_brightness[16][32] =
 	{ 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
 	  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f }
 };
+#endif
 
 uint8 S9xOpLengthsM0X0[256] =
 {
@@ -378,7 +378,8 @@ void InitGraphics (void)
 	if (!S9xBlitFilterInit()      |
 		!S9xBlit2xSaIFilterInit() |
 		!S9xBlitHQ2xFilterInit()  |
-		!S9xBlitNTSCFilterInit())
+		!S9xBlitNTSCFilterInit()  |
+		!S9xBlitPipelineInit(0))
 		QuitWithFatalError(0, "render 02");
 
 	switch (videoMode)
@@ -408,6 +409,7 @@ void InitGraphics (void)
 
 void DeinitGraphics (void)
 {
+	S9xBlitPipelineDeinit();
 	S9xBlitNTSCFilterDeinit();
 	S9xBlitHQ2xFilterDeinit();
 	S9xBlit2xSaIFilterDeinit();
@@ -450,17 +452,17 @@ static OSStatus BlitMPGLTask (void *parameter)
 			switch (mpDataBuffer->nx)
 			{
 				case -1:
-					(mpDataBuffer->blitFn) ((uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, blitGLBuffer, 1024 * 2, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
+					S9xBlitPipelineRun(mpDataBuffer->blitFn, (uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, blitGLBuffer, 1024 * 2, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
 					break;
 
 				case -2:
 					if (mpDataBuffer->srcHeight > SNES_HEIGHT_EXTENDED)
-						(mpDataBuffer->blitFn) ((uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, blitGLBuffer, 1024 * 2, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
+						S9xBlitPipelineRun(mpDataBuffer->blitFn, (uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, blitGLBuffer, 1024 * 2, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
 					else
 					{
 						uint8	*tmpBuffer = blitGLBuffer + (1024 * 512 * BYTES_PER_PIXEL);
 						int		aligned    = ((ntsc_width + 2) >> 1) << 1;
-						(mpDataBuffer->blitFn) ((uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, tmpBuffer, 1024 * 2, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
+						S9xBlitPipelineRun(mpDataBuffer->blitFn, (uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, tmpBuffer, 1024 * 2, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
 						S9xBlitPixHiResMixedTV16(tmpBuffer, 1024 * 2, blitGLBuffer, 1024 * 2, aligned, mpDataBuffer->copyHeight);
 						mpDataBuffer->copyHeight *= 2;
 					}
@@ -469,7 +471,7 @@ static OSStatus BlitMPGLTask (void *parameter)
 
 				default:
 					int	dstbytes = (OpenGL.rangeExt ? mpDataBuffer->copyWidth : ((mpDataBuffer->copyWidth > 512) ? 1024 : 512)) * 2;
-					(mpDataBuffer->blitFn) ((uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, blitGLBuffer, dstbytes, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
+					S9xBlitPipelineRun(mpDataBuffer->blitFn, (uint8 *) mpDataBuffer->gfxBuffer, mpDataBuffer->srcRowBytes, blitGLBuffer, dstbytes, mpDataBuffer->srcWidth, mpDataBuffer->srcHeight);
 					break;
 			}
 
@@ -1913,17 +1915,17 @@ static void S9xPutImageBlitGL (int width, int height)
 		switch (nx)
 		{
 			case -1:
-				blitFn((uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
+				S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
 				break;
 
 			case -2:
 				if (height > SNES_HEIGHT_EXTENDED)
-					blitFn((uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
+					S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
 				else
 				{
 					uint8	*tmpBuffer = blitGLBuffer + (1024 * 512 * BYTES_PER_PIXEL);
 					int		aligned    = ((ntsc_width + 2) >> 1) << 1;
-					blitFn((uint8 *) GFX.Screen, width * 2, tmpBuffer, 1024 * 2, width, height);
+					S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, tmpBuffer, 1024 * 2, width, height);
 					S9xBlitPixHiResMixedTV16(tmpBuffer, 1024 * 2, blitGLBuffer, 1024 * 2, aligned, copyHeight);
 					copyHeight *= 2;
 				}
@@ -1932,7 +1934,7 @@ static void S9xPutImageBlitGL (int width, int height)
 
 			default:
 				int	dstbytes = (OpenGL.rangeExt ? copyWidth : ((copyWidth > 512) ? 1024 : 512)) * 2;
-				blitFn((uint8 *) GFX.Screen, width * 2, blitGLBuffer, dstbytes, width, height);
+				S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, blitGLBuffer, dstbytes, width, height);
 				break;
 		}
 
@@ -2251,17 +2253,17 @@ static void S9xPutImageOverscanBlitGL (int width, int height)
 		switch (nx)
 		{
 			case -1:
-				blitFn((uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
+				S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
 				break;
 
 			case -2:
 				if (height > SNES_HEIGHT_EXTENDED)
-					blitFn((uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
+					S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, blitGLBuffer, 1024 * 2, width, height);
 				else
 				{
 					uint8	*tmpBuffer = blitGLBuffer + (1024 * 512 * BYTES_PER_PIXEL);
 					int		aligned    = ((ntsc_width + 2) >> 1) << 1;
-					blitFn((uint8 *) GFX.Screen, width * 2, tmpBuffer, 1024 * 2, width, height);
+					S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, tmpBuffer, 1024 * 2, width, height);
 					S9xBlitPixHiResMixedTV16(tmpBuffer, 1024 * 2, blitGLBuffer, 1024 * 2, aligned, copyHeight);
 					copyHeight *= 2;
 				}
@@ -2270,7 +2272,7 @@ static void S9xPutImageOverscanBlitGL (int width, int height)
 
 			default:
 				int	dstbytes = (OpenGL.rangeExt ? copyWidth : ((copyWidth > 512) ? 1024 : 512)) * 2;
-				blitFn((uint8 *) GFX.Screen, width * 2, blitGLBuffer, dstbytes, width, height);
+				S9xBlitPipelineRun(blitFn, (uint8 *) GFX.Screen, width * 2, blitGLBuffer, dstbytes, width, height);
 				break;
 		}
 
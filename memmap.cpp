@@ -187,6 +187,19 @@
 #include "jma/s9x-jma.h"
 #endif
 
+#ifdef HAVE_MMAP
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS	MAP_ANON
+#endif
+#ifndef O_NOFOLLOW
+#define O_NOFOLLOW		0
+#endif
+#endif
+
 #include "snes9x.h"
 #include "memmap.h"
 #include "apu/apu.h"
@@ -953,7 +966,7 @@ static int unzFindExtension (unzFile &, const char *, bool restart = TRUE, bool
 
 static void S9xDeinterleaveType1 (int size, uint8 *base)
 {
-	Settings.DisplayColor = BUILD_PIXEL(0, 31, 0);
+	Settings.DisplayColor = BUILD_PIXEL5(0, 31, 0);
 	SET_UI_COLOR(0, 255, 0);
 
 	uint8	blocks[256];
@@ -992,7 +1005,7 @@ static void S9xDeinterleaveType1 (int size, uint8 *base)
 static void S9xDeinterleaveType2 (int size, uint8 *base)
 {
 	// for odd Super FX images
-	Settings.DisplayColor = BUILD_PIXEL(31, 14, 6);
+	Settings.DisplayColor = BUILD_PIXEL5(31, 14, 6);
 	SET_UI_COLOR(255, 119, 25);
 
 	uint8	blocks[256];
@@ -1036,7 +1049,7 @@ static void S9xDeinterleaveGD24 (int size, uint8 *base)
 	if (size != 0x300000)
 		return;
 
-	Settings.DisplayColor = BUILD_PIXEL(0, 31, 31);
+	Settings.DisplayColor = BUILD_PIXEL5(0, 31, 31);
 	SET_UI_COLOR(0, 255, 255);
 
 	uint8	*tmp = (uint8 *) malloc(0x80000);
@@ -1055,44 +1068,25 @@ static void S9xDeinterleaveGD24 (int size, uint8 *base)
 
 // allocation and deallocation
 
+#define ROM_BUFFER_SIZE	(CMemory::MAX_ROM_SIZE + 0x200 + 0x8000)
+
 bool8 CMemory::Init (void)
 {
     RAM	 = (uint8 *) malloc(0x20000);
     SRAM = (uint8 *) malloc(0x20000);
     VRAM = (uint8 *) malloc(0x10000);
-    ROM  = (uint8 *) malloc(MAX_ROM_SIZE + 0x200 + 0x8000);
-
-	IPPU.TileCache[TILE_2BIT]       = (uint8 *) malloc(MAX_2BIT_TILES * 64);
-	IPPU.TileCache[TILE_4BIT]       = (uint8 *) malloc(MAX_4BIT_TILES * 64);
-	IPPU.TileCache[TILE_8BIT]       = (uint8 *) malloc(MAX_8BIT_TILES * 64);
-	IPPU.TileCache[TILE_2BIT_EVEN]  = (uint8 *) malloc(MAX_2BIT_TILES * 64);
-	IPPU.TileCache[TILE_2BIT_ODD]   = (uint8 *) malloc(MAX_2BIT_TILES * 64);
-	IPPU.TileCache[TILE_4BIT_EVEN]  = (uint8 *) malloc(MAX_4BIT_TILES * 64);
-	IPPU.TileCache[TILE_4BIT_ODD]   = (uint8 *) malloc(MAX_4BIT_TILES * 64);
-
-	IPPU.TileCached[TILE_2BIT]      = (uint8 *) malloc(MAX_2BIT_TILES);
-	IPPU.TileCached[TILE_4BIT]      = (uint8 *) malloc(MAX_4BIT_TILES);
-	IPPU.TileCached[TILE_8BIT]      = (uint8 *) malloc(MAX_8BIT_TILES);
-	IPPU.TileCached[TILE_2BIT_EVEN] = (uint8 *) malloc(MAX_2BIT_TILES);
-	IPPU.TileCached[TILE_2BIT_ODD]  = (uint8 *) malloc(MAX_2BIT_TILES);
-	IPPU.TileCached[TILE_4BIT_EVEN] = (uint8 *) malloc(MAX_4BIT_TILES);
-	IPPU.TileCached[TILE_4BIT_ODD]  = (uint8 *) malloc(MAX_4BIT_TILES);
-
-	if (!RAM || !SRAM || !VRAM || !ROM ||
-		!IPPU.TileCache[TILE_2BIT]       ||
-		!IPPU.TileCache[TILE_4BIT]       ||
-		!IPPU.TileCache[TILE_8BIT]       ||
-		!IPPU.TileCache[TILE_2BIT_EVEN]  ||
-		!IPPU.TileCache[TILE_2BIT_ODD]   ||
-		!IPPU.TileCache[TILE_4BIT_EVEN]  ||
-		!IPPU.TileCache[TILE_4BIT_ODD]   ||
-		!IPPU.TileCached[TILE_2BIT]      ||
-		!IPPU.TileCached[TILE_4BIT]      ||
-		!IPPU.TileCached[TILE_8BIT]      ||
-		!IPPU.TileCached[TILE_2BIT_EVEN] ||
-		!IPPU.TileCached[TILE_2BIT_ODD]  ||
-		!IPPU.TileCached[TILE_4BIT_EVEN] ||
-		!IPPU.TileCached[TILE_4BIT_ODD])
+#ifdef HAVE_MMAP
+	// Page aligned, so that ShareROM() can map a stored image over the ROM area.
+    ROM  = (uint8 *) mmap(NULL, ROM_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ROM == (uint8 *) MAP_FAILED)
+		ROM = NULL;
+#else
+    ROM  = (uint8 *) calloc(ROM_BUFFER_SIZE, 1);
+#endif
+
+	IPPU.TileCache.Data = (uint8 *) malloc(TILE_CACHE_SLOTS * 64);
+
+	if (!RAM || !SRAM || !VRAM || !ROM || !IPPU.TileCache.Data)
     {
 		Deinit();
 		return (FALSE);
@@ -1101,23 +1095,13 @@ bool8 CMemory::Init (void)
 	ZeroMemory(RAM,  0x20000);
 	ZeroMemory(SRAM, 0x20000);
 	ZeroMemory(VRAM, 0x10000);
-	ZeroMemory(ROM,  MAX_ROM_SIZE + 0x200 + 0x8000);
-
-	ZeroMemory(IPPU.TileCache[TILE_2BIT],       MAX_2BIT_TILES * 64);
-	ZeroMemory(IPPU.TileCache[TILE_4BIT],       MAX_4BIT_TILES * 64);
-	ZeroMemory(IPPU.TileCache[TILE_8BIT],       MAX_8BIT_TILES * 64);
-	ZeroMemory(IPPU.TileCache[TILE_2BIT_EVEN],  MAX_2BIT_TILES * 64);
-	ZeroMemory(IPPU.TileCache[TILE_2BIT_ODD],   MAX_2BIT_TILES * 64);
-	ZeroMemory(IPPU.TileCache[TILE_4BIT_EVEN],  MAX_4BIT_TILES * 64);
-	ZeroMemory(IPPU.TileCache[TILE_4BIT_ODD],   MAX_4BIT_TILES * 64);
-
-	ZeroMemory(IPPU.TileCached[TILE_2BIT],      MAX_2BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_4BIT],      MAX_4BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_8BIT],      MAX_8BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_2BIT_EVEN], MAX_2BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_2BIT_ODD],  MAX_2BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_4BIT_EVEN], MAX_4BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_4BIT_ODD],  MAX_4BIT_TILES);
+
+	// ROM comes from calloc() or mmap(), so the pages past the loaded image are never touched
+	// until something writes to them. ClearROM() keeps it that way for the first load.
+	ROMBufferUsed = FALSE;
+
+	ZeroMemory(IPPU.TileCache.Data, TILE_CACHE_SLOTS * 64);
+	S9xResetTileCache();
 
 	// FillRAM uses first 32K of ROM image area, otherwise space just
 	// wasted. Might be read by the SuperFX code.
@@ -1178,23 +1162,18 @@ void CMemory::Deinit (void)
 	if (ROM)
 	{
 		ROM -= 0x8000;
+	#ifdef HAVE_MMAP
+		munmap(ROM, ROM_BUFFER_SIZE);
+	#else
 		free(ROM);
+	#endif
 		ROM = NULL;
 	}
 
-	for (int t = 0; t < 7; t++)
+	if (IPPU.TileCache.Data)
 	{
-		if (IPPU.TileCache[t])
-		{
-			free(IPPU.TileCache[t]);
-			IPPU.TileCache[t] = NULL;
-		}
-
-		if (IPPU.TileCached[t])
-		{
-			free(IPPU.TileCached[t]);
-			IPPU.TileCached[t] = NULL;
-		}
+		free(IPPU.TileCache.Data);
+		IPPU.TileCache.Data = NULL;
 	}
 
 	Safe(NULL);
@@ -1371,6 +1350,17 @@ uint32 CMemory::HeaderRemove (uint32 size, int32 &headerCount, uint8 *buf)
 	return (size);
 }
 
+static void HeaderMessage (int32 headerCount)
+{
+    if (headerCount == 0)
+		S9xMessage(S9X_INFO, S9X_HEADERS_INFO, "No ROM file header found.");
+    else
+    if (headerCount == 1)
+		S9xMessage(S9X_INFO, S9X_HEADERS_INFO, "Found ROM file header (and ignored it).");
+	else
+		S9xMessage(S9X_INFO, S9X_HEADERS_INFO, "Found multiple ROM file headers (and ignored them).");
+}
+
 uint32 CMemory::FileLoader (uint8 *buffer, const char *filename, int32 maxsize)
 {
 	// <- ROM size without header
@@ -1491,29 +1481,149 @@ uint32 CMemory::FileLoader (uint8 *buffer, const char *filename, int32 maxsize)
 		}
 	}
 
-    if (HeaderCount == 0)
-		S9xMessage(S9X_INFO, S9X_HEADERS_INFO, "No ROM file header found.");
-    else
-    if (HeaderCount == 1)
-		S9xMessage(S9X_INFO, S9X_HEADERS_INFO, "Found ROM file header (and ignored it).");
-	else
-		S9xMessage(S9X_INFO, S9X_HEADERS_INFO, "Found multiple ROM file headers (and ignored them).");
+	HeaderMessage(HeaderCount);
 
 	return ((uint32) totalSize);
 }
 
-bool8 CMemory::LoadROM (const char *filename)
+uint32 CMemory::MemLoader (uint8 *buffer, const uint8 *source, uint32 sourceSize, int32 maxsize)
 {
-	int	retry_count = 0;
+	// Same as FileLoader() for a ROM image that is already in memory:
+	// it is copied into the buffer once, with no trip through a file.
+	// <- ROM size without header
+	// ** Memory.HeaderCount
+	// ** Memory.ROMFilename
+
+	uint32	size = (sourceSize < (uint32) maxsize + 0x200) ? sourceSize : (uint32) maxsize + 0x200;
+
+	memset(NSRTHeader, 0, sizeof(NSRTHeader));
+	HeaderCount = 0;
+
+	strcpy(ROMFilename, "MemoryROM");
+
+	memcpy(buffer, source, size);
+	size = HeaderRemove(size, HeaderCount, buffer);
+
+	HeaderMessage(HeaderCount);
+
+	return (size);
+}
 
+void CMemory::ClearROM (void)
+{
+	// The buffer is still all zero until the first image goes in.
+	if (ROMBufferUsed)
+	{
+	#ifdef HAVE_MMAP
+		// Fresh zero pages, which also drops a mapping made by ShareROM().
+		if (mmap(ROM, MAX_ROM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+	#endif
+		ZeroMemory(ROM, MAX_ROM_SIZE);
+	}
+
+	ROMBufferUsed = TRUE;
+}
+
+void CMemory::ShareROM (void)
+{
+	// Instances running the same game map one stored copy of the ROM image instead of keeping their own.
+	// The store is a directory of images named by CRC32 and size, best kept on a RAM-backed file system.
+	// The mapping is private: a page stays shared until this instance writes to it (cheats, BS-X flash...).
+#ifdef HAVE_MMAP
+	if (!Settings.ROMStoreDir[0] || !CalculatedSize)
+		return;
+
+	// The image can only be mapped over ROM if ROM starts on a page, which the 0x8000 offset misses with 16K/64K pages.
+	long	page = sysconf(_SC_PAGESIZE);
+	if (page <= 0 || ((pint) ROM & (page - 1)))
+		return;
+
+	size_t	size = CalculatedSize;
+	char	path[PATH_MAX + 32];
+	int		fd;
+
+	snprintf(path, sizeof(path), "%s" SLASH_STR "snes9x-%08x-%08x.rom", Settings.ROMStoreDir, ROMCRC32, CalculatedSize);
+
+	fd = open(path, O_RDONLY | O_NOFOLLOW);
+	if (fd < 0)
+	{
+		// Write under a temporary name first, so nobody maps a partly written image.
+		char	temp[PATH_MAX + 48];
+		size_t	done = 0;
+
+		snprintf(temp, sizeof(temp), "%s.%d", path, (int) getpid());
+
+		fd = open(temp, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW, 0644);
+		if (fd < 0)
+			return;
+
+		while (done < size)
+		{
+			ssize_t	n = write(fd, ROM + done, size - done);
+			if (n <= 0)
+				break;
+			done += n;
+		}
+
+		if (done < size || rename(temp, path))
+		{
+			close(fd);
+			unlink(temp);
+			return;
+		}
+	}
+
+	// Only map an image that matches ours byte for byte, in a file nobody else owns or can write.
+	// Otherwise a later rewrite would show through the pages not yet copied, so keep the private copy.
+	struct stat	st;
+	uint8		*stored = (uint8 *) MAP_FAILED;
+
+	if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_uid == getuid() && !(st.st_mode & (S_IWGRP | S_IWOTH)) && st.st_size == (off_t) size)
+		stored = (uint8 *) mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+
+	if (stored != (uint8 *) MAP_FAILED)
+	{
+		if (!memcmp(stored, ROM, size) &&
+			mmap(ROM, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+		{
+			// A failed MAP_FIXED may have unmapped the range, put the image back.
+			mmap(ROM, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+			memcpy(ROM, stored, size);
+		}
+
+		munmap(stored, size);
+	}
+
+	close(fd);
+#endif
+}
+
+bool8 CMemory::LoadROM (const char *filename)
+{
 	if (!filename || !*filename)
 		return (FALSE);
 
-	ZeroMemory(ROM, MAX_ROM_SIZE);
+	return (LoadROMInt(filename, NULL, 0));
+}
+
+bool8 CMemory::LoadROMMem (const uint8 *source, uint32 sourceSize)
+{
+	if (!source || !sourceSize)
+		return (FALSE);
+
+	return (LoadROMInt(NULL, source, sourceSize));
+}
+
+bool8 CMemory::LoadROMInt (const char *filename, const uint8 *source, uint32 sourceSize)
+{
+	// Loads from filename, or from source if filename is NULL.
+	int	retry_count = 0;
+
+	ClearROM();
 	ZeroMemory(&Multi, sizeof(Multi));
  
 again:
-	Settings.DisplayColor = BUILD_PIXEL(31, 31, 31);
+	Settings.DisplayColor = BUILD_PIXEL5(31, 31, 31);
 	SET_UI_COLOR(255, 255, 255);
 
 	CalculatedSize = 0;
@@ -1521,12 +1631,21 @@ again:
 
 	int32 totalFileSize;
 
-	totalFileSize = FileLoader(ROM, filename, MAX_ROM_SIZE);
-	if (!totalFileSize)
-		return (FALSE);
+	if (filename)
+	{
+		totalFileSize = FileLoader(ROM, filename, MAX_ROM_SIZE);
+		if (!totalFileSize)
+			return (FALSE);
 
-	if (!Settings.NoPatch)
-		CheckForAnyPatch(filename, HeaderCount != 0, totalFileSize);
+		if (!Settings.NoPatch)
+			CheckForAnyPatch(filename, HeaderCount != 0, totalFileSize);
+	}
+	else
+	{
+		totalFileSize = MemLoader(ROM, source, sourceSize, MAX_ROM_SIZE);
+		if (!totalFileSize)
+			return (FALSE);
+	}
 
 	int	hi_score, lo_score;
 
@@ -1715,7 +1834,7 @@ again:
 		}
 	}
 
-	if (strncmp(LastRomFilename, filename, PATH_MAX + 1))
+	if (filename && strncmp(LastRomFilename, filename, PATH_MAX + 1))
 	{
 		strncpy(LastRomFilename, filename, PATH_MAX + 1);
 		LastRomFilename[PATH_MAX] = 0;
@@ -1727,6 +1846,7 @@ again:
 	S9xLoadCheatFile(S9xGetFilename(".cht", CHEAT_DIR));
 
 	InitROM();
+	ShareROM();
 
 	S9xInitCheatData();
 	S9xApplyCheats();
@@ -1740,10 +1860,10 @@ bool8 CMemory::LoadMultiCart (const char *cartA, const char *cartB)
 {
 	bool8	r = TRUE;
 
-	ZeroMemory(ROM, MAX_ROM_SIZE);
+	ClearROM();
 	ZeroMemory(&Multi, sizeof(Multi));
 
-	Settings.DisplayColor = BUILD_PIXEL(31, 31, 31);
+	Settings.DisplayColor = BUILD_PIXEL5(31, 31, 31);
 	SET_UI_COLOR(255, 255, 255);
 
 	CalculatedSize = 0;
@@ -2116,7 +2236,35 @@ bool8 CMemory::SaveSRAM (const char *filename)
 
 static uint32 caCRC32 (uint8 *array, uint32 size, uint32 crc32)
 {
-	for (uint32 i = 0; i < size; i++)
+	// Slicing-by-8: crc32Slices[k][b] is the CRC of byte b followed by k zero bytes,
+	// so eight bytes are folded in with eight independent table lookups.
+	static uint32	crc32Slices[8][256];
+	static bool8	slicesBuilt = FALSE;
+
+	if (!slicesBuilt)
+	{
+		for (int b = 0; b < 256; b++)
+		{
+			crc32Slices[0][b] = crc32Table[b];
+			for (int k = 1; k < 8; k++)
+				crc32Slices[k][b] = (crc32Slices[k - 1][b] >> 8) ^ crc32Table[crc32Slices[k - 1][b] & 0xFF];
+		}
+
+		slicesBuilt = TRUE;
+	}
+
+	uint32	i = 0;
+
+	for (; i + 8 <= size; i += 8)
+	{
+		uint32	lo = crc32 ^ (array[i] | (array[i + 1] << 8) | (array[i + 2] << 16) | ((uint32) array[i + 3] << 24));
+		uint32	hi = array[i + 4] | (array[i + 5] << 8) | (array[i + 6] << 16) | ((uint32) array[i + 7] << 24);
+
+		crc32 = crc32Slices[7][lo & 0xFF] ^ crc32Slices[6][(lo >> 8) & 0xFF] ^ crc32Slices[5][(lo >> 16) & 0xFF] ^ crc32Slices[4][lo >> 24] ^
+				crc32Slices[3][hi & 0xFF] ^ crc32Slices[2][(hi >> 8) & 0xFF] ^ crc32Slices[1][(hi >> 16) & 0xFF] ^ crc32Slices[0][hi >> 24];
+	}
+
+	for (; i < size; i++)
 		crc32 = ((crc32 >> 8) & 0x00FFFFFF) ^ crc32Table[(crc32 ^ array[i]) & 0xFF];
 
 	return (~crc32);
@@ -2577,13 +2725,13 @@ void CMemory::InitROM (void)
 	// checksum
 	if (!isChecksumOK || ((uint32) CalculatedSize > (uint32) (((1 << (ROMSize - 7)) * 128) * 1024)))
 	{
-		Settings.DisplayColor = BUILD_PIXEL(31, 31, 0);
+		Settings.DisplayColor = BUILD_PIXEL5(31, 31, 0);
 		SET_UI_COLOR(255, 255, 0);
 	}
 
 	if (Multi.cartType == 4)
 	{
-		Settings.DisplayColor = BUILD_PIXEL(0, 16, 31);
+		Settings.DisplayColor = BUILD_PIXEL5(0, 16, 31);
 		SET_UI_COLOR(0, 128, 255);
 	}
 
@@ -3506,7 +3654,7 @@ void CMemory::ApplyROMFixes (void)
 		(match_na("FX SKIING NINTENDO 96") && (ROM[0x7fda] == 0)) ||
 		(match_nn("HONKAKUHA IGO GOSEI")   && (ROM[0xffd5] != 0x31)))
 	{
-		Settings.DisplayColor = BUILD_PIXEL(31, 0, 0);
+		Settings.DisplayColor = BUILD_PIXEL5(31, 0, 0);
 		SET_UI_COLOR(255, 0, 0);
 	}
 
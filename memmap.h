@@ -234,6 +234,7 @@ struct CMemory
 	uint8	*OBC1RAM;
 	uint8	*BSRAM;
 	uint8	*BIOSROM;
+	bool8	ROMBufferUsed;
 
 	uint8	*Map[MEMMAP_NUM_BLOCKS];
 	uint8	*WriteMap[MEMMAP_NUM_BLOCKS];
@@ -272,7 +273,12 @@ struct CMemory
 	int		ScoreLoROM (bool8, int32 romoff = 0);
 	uint32	HeaderRemove (uint32, int32 &, uint8 *);
 	uint32	FileLoader (uint8 *, const char *, int32);
+	uint32	MemLoader (uint8 *, const uint8 *, uint32, int32);
+	void	ClearROM (void);
+	void	ShareROM (void);
 	bool8	LoadROM (const char *);
+	bool8	LoadROMMem (const uint8 *, uint32);
+	bool8	LoadROMInt (const char *, const uint8 *, uint32);
 	bool8	LoadMultiCart (const char *, const char *);
 	bool8	LoadSufamiTurbo (const char *, const char *);
 	bool8	LoadSameGame (const char *, const char *);
@@ -180,6 +180,10 @@
 #ifndef __WIN32__
 #include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "snes9x.h"
 #include "memmap.h"
 #include "controls.h"
@@ -202,6 +206,9 @@
 #define SMV_VERSION				5
 #define SMV_HEADER_SIZE			64
 #define SMV_EXTRAROMINFO_SIZE	30
+#define SMV_KEYFRAME_MAGIC		0x4b564d53 // SMVK
+#define SMV_KEYFRAME_HEADER_SIZE	24
+#define SMV_KEYFRAME_ENTRY_SIZE	16
 #define BUFFER_GROWTH_SIZE		4096
 
 enum MovieState
@@ -211,6 +218,16 @@ enum MovieState
 	MOVIE_STATE_RECORD
 };
 
+struct SMovieKeyframe
+{
+	uint32	Frame;
+	uint32	Sample;
+	uint32	InputOffset;
+	uint32	Size;
+	uint8	*Data;
+	uint32	FileOffset;	// where the state is in the movie file while it is not loaded
+};
+
 struct SMovie
 {
 	enum MovieState	State;
@@ -241,6 +258,15 @@ struct SMovie
 	uint8	*InputBuffer;
 	uint8	*InputBufferPtr;
 	uint32	InputBufferSize;
+	uint8	*InputMap;
+	size_t	InputMapSize;
+
+	uint32	KeyframeInterval;
+	uint32	NumKeyframes;
+	bool8	KeyframePending;
+	bool8	KeyframesChanged;
+	uint32	KeyframeFileSize;
+	struct SMovieKeyframe	*Keyframes;
 };
 
 static struct SMovie	Movie;
@@ -261,6 +287,15 @@ static void		store_movie_settings (void);
 static void		restore_movie_settings (void);
 static int		bytes_per_sample (void);
 static void		reserve_buffer_space (uint32);
+static bool8	map_input_buffer (FILE *);
+static void		unmap_input_buffer (bool8);
+static void		store_keyframe (void);
+static bool8	load_keyframe (struct SMovieKeyframe *);
+static bool8	restore_keyframe (struct SMovieKeyframe *);
+static void		drop_keyframes (uint32, uint32);
+static uint32	keyframe_block_offset (void);
+static void		read_movie_keyframes (FILE *);
+static void		write_movie_keyframes (void);
 static void		reset_controllers (void);
 static void		read_frame_controller_data (bool);
 static void		write_frame_controller_data (void);
@@ -394,6 +429,9 @@ static int bytes_per_sample (void)
 
 static void reserve_buffer_space (uint32 space_needed)
 {
+	// anything that writes input goes through here, so a mapped buffer never gets written to
+	unmap_input_buffer(TRUE);
+
 	if (space_needed > Movie.InputBufferSize)
 	{
 		uint32 ptr_offset   = Movie.InputBufferPtr - Movie.InputBuffer;
@@ -405,6 +443,303 @@ static void reserve_buffer_space (uint32 space_needed)
 	}
 }
 
+// Playback maps the input straight from the movie file instead of reading it all in.
+// The mapping is private and read ahead; reserve_buffer_space() turns it into a heap copy before any write.
+
+static bool8 map_input_buffer (FILE *fd)
+{
+#ifdef HAVE_MMAP
+	uint32		length = Movie.BytesPerSample * (Movie.MaxSample + 1);
+	struct stat	st;
+
+	// a short file would fault past its end, let fread() deal with it
+	if (fstat(fileno(fd), &st) || st.st_size < (off_t) Movie.ControllerDataOffset + (off_t) length)
+		return (FALSE);
+
+	uint32	page  = (uint32) sysconf(_SC_PAGESIZE);
+	uint32	start = Movie.ControllerDataOffset - Movie.ControllerDataOffset % page;
+	size_t	size  = Movie.ControllerDataOffset - start + length;
+	uint8	*map;
+
+	map = (uint8 *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fd), start);
+	if (map == (uint8 *) MAP_FAILED)
+		return (FALSE);
+
+	madvise(map, size, MADV_WILLNEED);
+
+	unmap_input_buffer(FALSE);
+	free(Movie.InputBuffer);
+
+	Movie.InputMap        = map;
+	Movie.InputMapSize    = size;
+	Movie.InputBuffer     = map + (Movie.ControllerDataOffset - start);
+	Movie.InputBufferPtr  = Movie.InputBuffer;
+	Movie.InputBufferSize = length;
+
+	return (TRUE);
+#else
+	return (FALSE);
+#endif
+}
+
+static void unmap_input_buffer (bool8 keep_data)
+{
+#ifdef HAVE_MMAP
+	if (!Movie.InputMap)
+		return;
+
+	uint32	ptr_offset = Movie.InputBufferPtr - Movie.InputBuffer;
+	uint8	*buf       = NULL;
+
+	if (keep_data)
+	{
+		buf = (uint8 *) malloc(Movie.InputBufferSize);
+		memcpy(buf, Movie.InputBuffer, Movie.InputBufferSize);
+	}
+	else
+		Movie.InputBufferSize = 0;
+
+	munmap(Movie.InputMap, Movie.InputMapSize);
+	Movie.InputMap       = NULL;
+	Movie.InputMapSize   = 0;
+	Movie.InputBuffer    = buf;
+	Movie.InputBufferPtr = buf + (keep_data ? ptr_offset : 0);
+#endif
+}
+
+// Keyframes are states saved every Settings.MovieKeyframeInterval frames as the movie goes by,
+// Keyframes[n] being the one for frame n * KeyframeInterval. S9xMovieSeek() starts from them.
+// They hold no movie block, the position in the input is kept beside them.
+// Only a movie that is not read-only gets them written back into its file.
+
+static void store_keyframe (void)
+{
+	uint32	n = Movie.CurrentFrame / Movie.KeyframeInterval;
+
+	Movie.KeyframePending = FALSE;
+
+	if (n >= Movie.NumKeyframes)
+	{
+		uint32	num = max(n + 1, Movie.NumKeyframes * 2);
+
+		Movie.Keyframes = (struct SMovieKeyframe *) realloc(Movie.Keyframes, num * sizeof(struct SMovieKeyframe));
+		ZeroMemory(Movie.Keyframes + Movie.NumKeyframes, (num - Movie.NumKeyframes) * sizeof(struct SMovieKeyframe));
+		Movie.NumKeyframes = num;
+	}
+
+	struct SMovieKeyframe	*k = &Movie.Keyframes[n];
+	MovieState				state = Movie.State;
+
+	if (k->Data || k->FileOffset)
+		return;
+
+	Movie.State = MOVIE_STATE_NONE;
+	if (!S9xFreezeGameMem(&k->Data, &k->Size))
+	{
+		k->Data = NULL;
+		k->Size = 0;
+	}
+	Movie.State = state;
+	Movie.KeyframesChanged = TRUE;
+
+	k->Frame       = Movie.CurrentFrame;
+	k->Sample      = Movie.CurrentSample;
+	k->InputOffset = (uint32) (Movie.InputBufferPtr - Movie.InputBuffer);
+}
+
+// reads a state that is still in the movie file
+static bool8 load_keyframe (struct SMovieKeyframe *k)
+{
+	if (k->Data || !k->FileOffset)
+		return (k->Data != NULL);
+
+	long	pos = ftell(Movie.File);
+
+	k->Data = new uint8[k->Size];
+	if (fseek(Movie.File, k->FileOffset, SEEK_SET) || fread(k->Data, 1, k->Size, Movie.File) != k->Size)
+	{
+		delete [] k->Data;
+		k->Data = NULL;
+		k->Size = 0;
+	}
+
+	k->FileOffset = 0;
+	fseek(Movie.File, pos, SEEK_SET);
+
+	return (k->Data != NULL);
+}
+
+static bool8 restore_keyframe (struct SMovieKeyframe *k)
+{
+	MovieState	state = Movie.State;
+	int			result;
+
+	if (!load_keyframe(k))
+		return (FALSE);
+
+	Movie.State = MOVIE_STATE_NONE;
+	result = S9xUnfreezeGameMem(k->Data, k->Size);
+	Movie.State = state;
+
+	if (result != SUCCESS)
+		return (FALSE);
+
+	// the joypads were restored with the state
+	Movie.CurrentFrame   = k->Frame;
+	Movie.CurrentSample  = k->Sample;
+	Movie.InputBufferPtr = Movie.InputBuffer + k->InputOffset;
+
+	return (TRUE);
+}
+
+// drops the keyframes from 'frame' on, and those made from input past the first 'same_input' bytes
+static void drop_keyframes (uint32 frame, uint32 same_input)
+{
+	for (uint32 n = 0; n < Movie.NumKeyframes; n++)
+	{
+		struct SMovieKeyframe	*k = &Movie.Keyframes[n];
+
+		if ((k->Data || k->FileOffset) && (k->Frame >= frame || k->InputOffset > same_input))
+		{
+			delete [] k->Data;
+			k->Data       = NULL;
+			k->Size       = 0;
+			k->FileOffset = 0;
+			Movie.KeyframesChanged = TRUE;
+		}
+	}
+
+	Movie.KeyframePending = FALSE;
+}
+
+// The keyframes are kept in an optional block right after the input, where older versions never look:
+//   magic, movie id, rerecord count, max sample, interval, count,
+//   then for each keyframe: frame, sample, input offset, size and the state (no state if size is 0).
+// The id, rerecord count and max sample tie it to the input it was made from.
+
+static uint32 keyframe_block_offset (void)
+{
+	return (Movie.ControllerDataOffset + Movie.BytesPerSample * (Movie.MaxSample + 1));
+}
+
+static void read_movie_keyframes (FILE *fd)
+{
+	uint8	buf[SMV_KEYFRAME_HEADER_SIZE], *ptr = buf;
+	uint32	offset = keyframe_block_offset();
+	long	file_size;
+
+	// movies with the state after the input have no room for it
+	if (Movie.SaveStateOffset > Movie.ControllerDataOffset)
+		return;
+
+	if (fseek(fd, 0, SEEK_END) || (file_size = ftell(fd)) < 0)
+		return;
+
+	if (fseek(fd, offset, SEEK_SET) || fread(buf, 1, SMV_KEYFRAME_HEADER_SIZE, fd) != SMV_KEYFRAME_HEADER_SIZE)
+		return;
+
+	if (Read32(ptr) != SMV_KEYFRAME_MAGIC || Read32(ptr) != Movie.MovieId || Read32(ptr) != Movie.RerecordCount || Read32(ptr) != Movie.MaxSample)
+		return;
+
+	uint32	interval = Read32(ptr);
+	uint32	num      = Read32(ptr);
+	uint32	pos      = offset + SMV_KEYFRAME_HEADER_SIZE;
+
+	if (!interval || !num || num > Movie.MaxFrame / interval + 1)
+		return;
+
+	struct SMovieKeyframe	*keyframes = (struct SMovieKeyframe *) calloc(num, sizeof(struct SMovieKeyframe));
+
+	for (uint32 n = 0; n < num; n++)
+	{
+		struct SMovieKeyframe	*k = &keyframes[n];
+		uint8					entry[SMV_KEYFRAME_ENTRY_SIZE];
+
+		ptr = entry;
+		if (fread(entry, 1, SMV_KEYFRAME_ENTRY_SIZE, fd) != SMV_KEYFRAME_ENTRY_SIZE)
+			break;
+
+		k->Frame       = Read32(ptr);
+		k->Sample      = Read32(ptr);
+		k->InputOffset = Read32(ptr);
+		k->Size        = Read32(ptr);
+		pos += SMV_KEYFRAME_ENTRY_SIZE;
+
+		if (k->Size > (uint32) file_size - pos || (k->Size && (k->Frame != n * interval || k->Sample > Movie.MaxSample || k->InputOffset > offset - Movie.ControllerDataOffset)))
+			break;
+
+		if (k->Size)
+			k->FileOffset = pos;
+
+		pos += k->Size;
+		if (fseek(fd, pos, SEEK_SET))
+			break;
+
+		if (n == num - 1)
+		{
+			Movie.KeyframeInterval = interval;
+			Movie.NumKeyframes     = num;
+			Movie.Keyframes        = keyframes;
+			Movie.KeyframeFileSize = pos - offset;
+			return;
+		}
+	}
+
+	free(keyframes);
+}
+
+static void write_movie_keyframes (void)
+{
+	if (!Movie.File || Movie.ReadOnly || !Movie.KeyframesChanged || Movie.SaveStateOffset > Movie.ControllerDataOffset)
+		return;
+
+	// the block is rewritten from the start, so get the states still in it first
+	for (uint32 n = 0; n < Movie.NumKeyframes; n++)
+		load_keyframe(&Movie.Keyframes[n]);
+
+	uint8	buf[SMV_KEYFRAME_HEADER_SIZE], *ptr = buf;
+	uint32	num = Movie.NumKeyframes;
+	size_t	ignore;
+
+	Movie.KeyframesChanged = FALSE;
+	Movie.KeyframeFileSize = 0;
+
+	while (num && !Movie.Keyframes[num - 1].Data)
+		num--;
+
+	if (!num)
+		return;
+
+	Write32(SMV_KEYFRAME_MAGIC, ptr);
+	Write32(Movie.MovieId, ptr);
+	Write32(Movie.RerecordCount, ptr);
+	Write32(Movie.MaxSample, ptr);
+	Write32(Movie.KeyframeInterval, ptr);
+	Write32(num, ptr);
+
+	fseek(Movie.File, keyframe_block_offset(), SEEK_SET);
+	ignore = fwrite(buf, 1, SMV_KEYFRAME_HEADER_SIZE, Movie.File);
+	Movie.KeyframeFileSize = SMV_KEYFRAME_HEADER_SIZE;
+
+	for (uint32 n = 0; n < num; n++)
+	{
+		struct SMovieKeyframe	*k = &Movie.Keyframes[n];
+		uint8					entry[SMV_KEYFRAME_ENTRY_SIZE];
+		uint32					size = k->Data ? k->Size : 0;
+
+		ptr = entry;
+		Write32(k->Frame, ptr);
+		Write32(k->Sample, ptr);
+		Write32(k->InputOffset, ptr);
+		Write32(size, ptr);
+
+		ignore = fwrite(entry, 1, SMV_KEYFRAME_ENTRY_SIZE, Movie.File);
+		if (size)
+			ignore = fwrite(k->Data, 1, size, Movie.File);
+		Movie.KeyframeFileSize += SMV_KEYFRAME_ENTRY_SIZE + size;
+	}
+}
+
 static void reset_controllers (void)
 {
 	for (int i = 0; i < 8; i++)
@@ -549,7 +884,7 @@ static void truncate_movie (void)
 		return;
 
 	int	ignore;
-	ignore = ftruncate(fileno(Movie.File), Movie.ControllerDataOffset + Movie.BytesPerSample * (Movie.MaxSample + 1));
+	ignore = ftruncate(fileno(Movie.File), keyframe_block_offset() + Movie.KeyframeFileSize);
 }
 
 static int read_movie_header (FILE *fd, SMovie *movie)
@@ -661,12 +996,32 @@ static void change_state (MovieState new_state)
 	if (Movie.State == MOVIE_STATE_RECORD)
 		flush_movie();
 
+	// recorded input runs over the keyframe block in the file, it is written again when the movie is closed
+	if (new_state == MOVIE_STATE_RECORD && Movie.KeyframeFileSize)
+	{
+		for (uint32 n = 0; n < Movie.NumKeyframes; n++)
+			load_keyframe(&Movie.Keyframes[n]);
+
+		Movie.KeyframeFileSize = 0;
+		Movie.KeyframesChanged = TRUE;
+	}
+
 	if (new_state == MOVIE_STATE_NONE)
 	{
+		write_movie_keyframes();
 		truncate_movie();
 		fclose(Movie.File);
 		Movie.File = NULL;
 
+		unmap_input_buffer(FALSE);
+
+		drop_keyframes(0, 0);
+		free(Movie.Keyframes);
+		Movie.Keyframes        = NULL;
+		Movie.NumKeyframes     = 0;
+		Movie.KeyframesChanged = FALSE;
+		Movie.KeyframeFileSize = 0;
+
 		if (S9xMoviePlaying() || S9xMovieRecording())
 			restore_previous_settings();
 	}
@@ -727,6 +1082,15 @@ int S9xMovieUnfreeze (uint8 *buf, uint32 size)
 
 	if (!Movie.ReadOnly)
 	{
+		// keyframes stay good as long as the input leading up to them does
+		uint32	old_size   = Movie.BytesPerSample * (Movie.MaxSample + 1);
+		uint32	same_input = 0;
+
+		while (same_input < space_needed && same_input < old_size && Movie.InputBuffer[same_input] == ptr[same_input])
+			same_input++;
+
+		drop_keyframes(current_frame + 1, same_input);
+
 		change_state(MOVIE_STATE_RECORD);
 
 		Movie.CurrentFrame  = current_frame;
@@ -825,11 +1189,15 @@ int S9xMovieOpen (const char *filename, bool8 read_only)
 
 	Movie.File           = fd;
 	Movie.BytesPerSample = bytes_per_sample();
-	Movie.InputBufferPtr = Movie.InputBuffer;
-	reserve_buffer_space(Movie.BytesPerSample * (Movie.MaxSample + 1));
 
-	size_t	ignore;
-	ignore = fread(Movie.InputBufferPtr, 1, Movie.BytesPerSample * (Movie.MaxSample + 1), fd);
+	if (!map_input_buffer(fd))
+	{
+		Movie.InputBufferPtr = Movie.InputBuffer;
+		reserve_buffer_space(Movie.BytesPerSample * (Movie.MaxSample + 1));
+
+		size_t	ignore;
+		ignore = fread(Movie.InputBufferPtr, 1, Movie.BytesPerSample * (Movie.MaxSample + 1), fd);
+	}
 
 	// read "baseline" controller data
 	if (Movie.MaxSample && Movie.MaxFrame)
@@ -841,8 +1209,15 @@ int S9xMovieOpen (const char *filename, bool8 read_only)
 	strncpy(Movie.Filename, filename, PATH_MAX + 1);
 	Movie.Filename[PATH_MAX] = 0;
 
+	// keyframes saved in the file keep their own interval
+	Movie.KeyframeInterval = Settings.MovieKeyframeInterval;
+	read_movie_keyframes(fd);
+
 	change_state(MOVIE_STATE_PLAY);
 
+	if (Settings.MovieKeyframeInterval)
+		store_keyframe();
+
 	S9xUpdateFrameCounter(-1);
 
 	S9xMessage(S9X_INFO, S9X_MOVIE_INFO, MOVIE_INFO_REPLAY);
@@ -946,6 +1321,10 @@ int S9xMovieCreate (const char *filename, uint8 controllers_mask, uint8 opts, co
 
 	change_state(MOVIE_STATE_RECORD);
 
+	Movie.KeyframeInterval = Settings.MovieKeyframeInterval;
+	if (Movie.KeyframeInterval)
+		store_keyframe();
+
 	S9xUpdateFrameCounter(-1);
 
 	S9xMessage(S9X_INFO, S9X_MOVIE_INFO, MOVIE_INFO_RECORD);
@@ -1069,9 +1448,13 @@ void S9xMovieUpdate (bool addFrame)
 			if (addFrame)
 				S9xUpdateFrameCounter();
 
-			break;
+			return;
 		}
 	}
+
+	// the state is saved once the frame is over, see S9xMovieUpdateKeyframe()
+	if (addFrame && Settings.MovieKeyframeInterval && Movie.KeyframeInterval && Movie.CurrentFrame % Movie.KeyframeInterval == 0)
+		Movie.KeyframePending = TRUE;
 }
 
 void S9xMovieUpdateOnReset (void)
@@ -1089,6 +1472,47 @@ void S9xMovieUpdateOnReset (void)
 	}
 }
 
+// called between frames, where a state can be saved
+void S9xMovieUpdateKeyframe (void)
+{
+	if (Movie.KeyframePending)
+		store_keyframe();
+}
+
+// Goes back or ahead to the latest keyframe at or before 'frame' when that is closer than where playback is.
+// Returns how many frames are left to run to get to 'frame', or -1 if it is behind and no keyframe helps.
+int S9xMovieSeek (uint32 frame)
+{
+	if (!S9xMovieActive())
+		return (-1);
+
+	if (Movie.State == MOVIE_STATE_PLAY && Movie.KeyframeInterval)
+	{
+		uint32	n = frame / Movie.KeyframeInterval + 1;
+
+		if (n > Movie.NumKeyframes)
+			n = Movie.NumKeyframes;
+
+		while (n--)
+		{
+			struct SMovieKeyframe	*k = &Movie.Keyframes[n];
+
+			if (!(k->Data || k->FileOffset) || k->Frame > frame)
+				continue;
+
+			if ((frame < Movie.CurrentFrame || k->Frame > Movie.CurrentFrame) && restore_keyframe(k))
+				S9xUpdateFrameCounter(-1);
+
+			break;
+		}
+	}
+
+	if (frame < Movie.CurrentFrame)
+		return (-1);
+
+	return ((int) (frame - Movie.CurrentFrame));
+}
+
 void S9xMovieInit (void)
 {
 	ZeroMemory(&Movie, sizeof(Movie));
@@ -222,12 +222,14 @@ void S9xMovieStop (bool8);
 void S9xMovieToggleRecState (void);
 void S9xMovieToggleFrameDisplay (void);
 const char * S9xChooseMovieFilename (bool8);
+int S9xMovieSeek (uint32);
 
 // methods used by the emulation
 void S9xMovieInit (void);
 void S9xMovieShutdown (void);
 void S9xMovieUpdate (bool a = true);
 void S9xMovieUpdateOnReset (void);
+void S9xMovieUpdateKeyframe (void);
 void S9xUpdateFrameCounter (int o = 0);
 void S9xMovieFreeze (uint8 **, uint32 *);
 int S9xMovieUnfreeze (uint8 *, uint32);
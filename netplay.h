@@ -201,6 +201,14 @@
 
 #define NP_MAX_CLIENTS 8
 
+// Connections beyond the NP_MAX_CLIENTS player slots are spectators.
+// Player numbers are sent as one byte, so this caps them.
+#define NP_MAX_CONNECTIONS 255
+
+// Bytes a client may have waiting on top of one ROM image before the
+// server gives up on it rather than let a stalled socket grow the queue.
+#define NP_MAX_SEND_BACKLOG (4 * 1024 * 1024)
+
 #define NP_SERV_MAGIC 'S'
 #define NP_CLNT_MAGIC 'C'
 
@@ -227,6 +235,26 @@
 #define NP_SERV_SRAM_DATA 7
 #define NP_SERV_READY 8
 
+// Data queued to more than one client, such as a ROM image or freeze file.
+// Only the server thread touches the reference count.
+struct SNPBuffer
+{
+    int    RefCount;
+    uint32 Length;
+    uint8 *Data;
+};
+
+// One outgoing message: a small per-client header (it carries the
+// sequence number) followed by an optional shared body.
+struct SNPPacket
+{
+    uint8  Header [7 + 1 + 4];
+    uint32 HeaderLength;
+    uint32 Sent;
+    struct SNPBuffer *Body;
+    struct SNPPacket *Next;
+};
+
 struct SNPClient
 {
     volatile uint8 SendSequenceNum;
@@ -239,6 +267,14 @@ struct SNPClient
     char *ROMName;
     char *HostName;
     char *Who;
+    struct SNPPacket *SendHead;
+    struct SNPPacket *SendTail;
+    uint32 SendQueued;
+    bool8  WantWrite;
+    uint8  ReceiveHeader [7];
+    uint32 ReceiveGot;
+    uint32 ReceiveLength;
+    uint8 *ReceiveBody;
 };
 
 enum {
@@ -262,12 +298,16 @@ struct NPServerTask
 
 struct SNPServer
 {
-    struct SNPClient Clients [NP_MAX_CLIENTS];
+    struct SNPClient *Clients;
+    int    MaxClients;
     int    NumClients;
     volatile struct NPServerTask TaskQueue [NP_MAX_TASKS];
     volatile uint32 TaskHead;
     volatile uint32 TaskTail;
     int    Socket;
+#ifdef __linux__
+    int    EpollFD;
+#endif
     uint32 FrameTime;
     uint32 FrameCount;
     char   ROMName [30];
@@ -351,6 +351,26 @@ extern uint32	SPARE_RGB_BIT_MASK;
 #define THIRD_COLOR_MASK_RGB5551	0x003e
 #define ALPHA_BITS_MASK_RGB5551		0x0001
 
+/* XRGB8888 format, 8 bits per channel */
+#define BUILD_PIXEL_XRGB8888(R, G, B)			(((uint32) (R) << 16) | ((uint32) (G) << 8) | (uint32) (B))
+#define BUILD_PIXEL2_XRGB8888(R, G, B)			(((uint32) (R) << 16) | ((uint32) (G) << 8) | (uint32) (B))
+#define DECOMPOSE_PIXEL_XRGB8888(PIX, R, G, B)	{ (R) = ((PIX) >> 16) & 0xff; (G) = ((PIX) >> 8) & 0xff; (B) = (PIX) & 0xff; }
+#define SPARE_RGB_BIT_MASK_XRGB8888				(1 << 24)
+
+#define MAX_RED_XRGB8888			255
+#define MAX_GREEN_XRGB8888			255
+#define MAX_BLUE_XRGB8888			255
+#define RED_LOW_BIT_MASK_XRGB8888	0x010000
+#define GREEN_LOW_BIT_MASK_XRGB8888	0x000100
+#define BLUE_LOW_BIT_MASK_XRGB8888	0x000001
+#define RED_HI_BIT_MASK_XRGB8888	0x800000
+#define GREEN_HI_BIT_MASK_XRGB8888	0x008000
+#define BLUE_HI_BIT_MASK_XRGB8888	0x000080
+#define FIRST_COLOR_MASK_XRGB8888	0xff0000
+#define SECOND_COLOR_MASK_XRGB8888	0x00ff00
+#define THIRD_COLOR_MASK_XRGB8888	0x0000ff
+#define ALPHA_BITS_MASK_XRGB8888	0x000000
+
 #ifndef GFX_MULTI_FORMAT
 
 #define CONCAT(X, Y)	X##Y
@@ -404,4 +424,18 @@ extern uint32	SPARE_RGB_BIT_MASK;
 
 #endif
 
+// Storage type of one rendered pixel.
+// BUILD_PIXEL takes channel values in the range of the render format (0-31, or 0-255 for XRGB8888).
+// BUILD_PIXEL5/DECOMPOSE_PIXEL5 always work with the SNES's 5-bit channels, for UI colours and snapshot thumbnails.
+#ifdef GFX_XRGB8888
+typedef uint32	pixel_t;
+#define EXPAND_5TO8(C)						(((C) << 3) | ((C) >> 2))
+#define BUILD_PIXEL5(R, G, B)				BUILD_PIXEL(EXPAND_5TO8(R), EXPAND_5TO8(G), EXPAND_5TO8(B))
+#define DECOMPOSE_PIXEL5(PIX, R, G, B)		{ DECOMPOSE_PIXEL(PIX, R, G, B); (R) >>= 3; (G) >>= 3; (B) >>= 3; }
+#else
+typedef uint16	pixel_t;
+#define BUILD_PIXEL5(R, G, B)				BUILD_PIXEL(R, G, B)
+#define DECOMPOSE_PIXEL5(PIX, R, G, B)		DECOMPOSE_PIXEL(PIX, R, G, B)
+#endif
+
 #endif
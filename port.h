@@ -211,6 +211,11 @@
 #define PIXEL_FORMAT RGB555
 #endif
 
+#ifdef GFX_XRGB8888
+#undef GFX_MULTI_FORMAT
+#define PIXEL_FORMAT XRGB8888
+#endif
+
 #ifndef snes9x_types_defined
 #define snes9x_types_defined
 typedef unsigned char		bool8;
@@ -1230,7 +1230,10 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 		if (Settings.SA1     && Address >= 0x2200)
 		{
 			if (Address <= 0x23ff)
+			{
+				S9xSA1Sync();
 				S9xSetSA1(Byte, Address);
+			}
 			else
 				Memory.FillRAM[Address] = Byte;
 			return;
@@ -1535,7 +1538,10 @@ uint8 S9xGetPPU (uint16 Address)
 			return (S9xGetSuperFX(Address));
 		else
 		if (Settings.SA1     && Address >= 0x2200)
+		{
+			S9xSA1Sync();
 			return (S9xGetSA1(Address));
+		}
 		else
 		if (Settings.BS      && Address >= 0x2188 && Address <= 0x219f)
 			return (S9xGetBSXPPU(Address));
@@ -2182,13 +2188,8 @@ void S9xSoftResetPPU (void)
 	IPPU.ColorsChanged = TRUE;
 	IPPU.OBJChanged = TRUE;
 	IPPU.DirectColourMapsNeedRebuild = TRUE;
-	ZeroMemory(IPPU.TileCached[TILE_2BIT], MAX_2BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_4BIT], MAX_4BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_8BIT], MAX_8BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_2BIT_EVEN], MAX_2BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_2BIT_ODD],  MAX_2BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_4BIT_EVEN], MAX_4BIT_TILES);
-	ZeroMemory(IPPU.TileCached[TILE_4BIT_ODD],  MAX_4BIT_TILES);
+	S9xResetTileCache();
+	S9xResetClipCache();
 #ifdef CORRECT_VRAM_READS
 	IPPU.VRAMReadBuffer = 0; // XXX: FIXME: anything better?
 #else
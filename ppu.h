@@ -192,6 +192,14 @@
 #define MAX_4BIT_TILES		2048
 #define MAX_8BIT_TILES		1024
 
+#define TILE_CACHE_SETS		1024
+#define TILE_CACHE_WAYS		4
+#define TILE_CACHE_SLOTS	(TILE_CACHE_SETS * TILE_CACHE_WAYS)
+#define TILE_CACHE_EMPTY	0xffff
+
+#define TILE_CACHE_TAG(Type, TileNumber)	(((Type) << 12) | (TileNumber))
+#define TILE_CACHE_SET(Type, TileNumber)	(((TileNumber) ^ ((Type) * 0x95)) & (TILE_CACHE_SETS - 1))
+
 #define CLIP_OR				0
 #define CLIP_AND			1
 #define CLIP_XOR			2
@@ -210,14 +218,32 @@ struct ClipData
 	uint16	Right[6];
 };
 
+// Decoded tiles live in a small set-associative cache rather than in one table per tile format.
+// Each set keeps its ways in most-recently-used order; Slot[] indexes the 64-byte entry in Data.
+
+struct TileCacheSet
+{
+	uint16	Tag[TILE_CACHE_WAYS];
+	uint16	Slot[TILE_CACHE_WAYS];
+	uint8	Blank[TILE_CACHE_WAYS];
+};
+
+struct TileCacheData
+{
+	struct TileCacheSet	Set[TILE_CACHE_SETS];
+	uint8	*Data;
+	uint32	Hits;
+	uint32	Misses;
+	uint32	Evictions;
+};
+
 struct InternalPPU
 {
 	struct ClipData Clip[2][6];
 	bool8	ColorsChanged;
 	bool8	OBJChanged;
 	bool8	DirectColourMapsNeedRebuild;
-	uint8	*TileCache[7];
-	uint8	*TileCached[7];
+	struct TileCacheData TileCache;
 #ifdef CORRECT_VRAM_READS
 	uint16	VRAMReadBuffer;
 #else
@@ -234,7 +260,7 @@ struct InternalPPU
 	uint32	Red[256];
 	uint32	Green[256];
 	uint32	Blue[256];
-	uint16	ScreenColors[256];
+	pixel_t	ScreenColors[256];
 	uint8	MaxBrightness;
 	bool8	RenderThisFrame;
 	int		RenderedScreenWidth;
@@ -389,6 +415,7 @@ void S9xCheckMissingHTimerPosition (int32);
 void S9xCheckMissingHTimerRange (int32, int32);
 void S9xCheckMissingHTimerHalt (int32, int32);
 void S9xFixColourBrightness (void);
+void S9xResetTileCache (void);
 void S9xDoAutoJoypad (void);
 
 #include "gfx.h"
@@ -523,6 +550,52 @@ static inline void REGISTER_2104 (uint8 Byte)
 		return;
 #endif
 
+static inline void S9xInvalidateCachedTile (uint32 Type, uint32 TileNumber)
+{
+	struct TileCacheSet	*set = &IPPU.TileCache.Set[TILE_CACHE_SET(Type, TileNumber)];
+	uint16				tag  = TILE_CACHE_TAG(Type, TileNumber);
+
+	for (int w = 0; w < TILE_CACHE_WAYS; w++)
+	{
+		if (set->Tag[w] == tag)
+		{
+			// Move the freed way to the back so it is the next one to be reused.
+			uint16	slot = set->Slot[w];
+
+			for (; w < TILE_CACHE_WAYS - 1; w++)
+			{
+				set->Tag[w]   = set->Tag[w + 1];
+				set->Slot[w]  = set->Slot[w + 1];
+				set->Blank[w] = set->Blank[w + 1];
+			}
+
+			set->Tag[w]  = TILE_CACHE_EMPTY;
+			set->Slot[w] = slot;
+
+			return;
+		}
+	}
+}
+
+// Hi-res tiles are built from two neighbouring tiles, so a write also affects the previous tile of those formats.
+
+static inline void S9xInvalidateCachedTiles (uint32 address)
+{
+	uint32	t2 = address >> 4, t4 = address >> 5;
+
+	S9xInvalidateCachedTile(TILE_2BIT, t2);
+	S9xInvalidateCachedTile(TILE_4BIT, t4);
+	S9xInvalidateCachedTile(TILE_8BIT, address >> 6);
+	S9xInvalidateCachedTile(TILE_2BIT_EVEN, t2);
+	S9xInvalidateCachedTile(TILE_2BIT_EVEN, (t2 - 1) & (MAX_2BIT_TILES - 1));
+	S9xInvalidateCachedTile(TILE_2BIT_ODD,  t2);
+	S9xInvalidateCachedTile(TILE_2BIT_ODD,  (t2 - 1) & (MAX_2BIT_TILES - 1));
+	S9xInvalidateCachedTile(TILE_4BIT_EVEN, t4);
+	S9xInvalidateCachedTile(TILE_4BIT_EVEN, (t4 - 1) & (MAX_4BIT_TILES - 1));
+	S9xInvalidateCachedTile(TILE_4BIT_ODD,  t4);
+	S9xInvalidateCachedTile(TILE_4BIT_ODD,  (t4 - 1) & (MAX_4BIT_TILES - 1));
+}
+
 static inline void REGISTER_2118 (uint8 Byte)
 {
 	CHECK_INBLANK();
@@ -538,17 +611,7 @@ static inline void REGISTER_2118 (uint8 Byte)
 	else
 		Memory.VRAM[address = (PPU.VMA.Address << 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	S9xInvalidateCachedTiles(address);
 
 	if (!PPU.VMA.High)
 	{
@@ -575,17 +638,7 @@ static inline void REGISTER_2119 (uint8 Byte)
 	else
 		Memory.VRAM[address = ((PPU.VMA.Address << 1) + 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	S9xInvalidateCachedTiles(address);
 
 	if (PPU.VMA.High)
 	{
@@ -606,17 +659,7 @@ static inline void REGISTER_2118_tile (uint8 Byte)
 
 	Memory.VRAM[address] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	S9xInvalidateCachedTiles(address);
 
 	if (!PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -631,17 +674,7 @@ static inline void REGISTER_2119_tile (uint8 Byte)
 
 	Memory.VRAM[address] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	S9xInvalidateCachedTiles(address);
 
 	if (PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -655,17 +688,7 @@ static inline void REGISTER_2118_linear (uint8 Byte)
 
 	Memory.VRAM[address = (PPU.VMA.Address << 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	S9xInvalidateCachedTiles(address);
 
 	if (!PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -679,17 +702,7 @@ static inline void REGISTER_2119_linear (uint8 Byte)
 
 	Memory.VRAM[address = ((PPU.VMA.Address << 1) + 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	S9xInvalidateCachedTiles(address);
 
 	if (PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -707,7 +720,7 @@ static inline void REGISTER_2122 (uint8 Byte)
 			IPPU.ColorsChanged = TRUE;
 			IPPU.Blue[PPU.CGADD] = IPPU.XB[(Byte >> 2) & 0x1f];
 			IPPU.Green[PPU.CGADD] = IPPU.XB[(PPU.CGDATA[PPU.CGADD] >> 5) & 0x1f];
-			IPPU.ScreenColors[PPU.CGADD] = (uint16) BUILD_PIXEL(IPPU.Red[PPU.CGADD], IPPU.Green[PPU.CGADD], IPPU.Blue[PPU.CGADD]);
+			IPPU.ScreenColors[PPU.CGADD] = (pixel_t) BUILD_PIXEL(IPPU.Red[PPU.CGADD], IPPU.Green[PPU.CGADD], IPPU.Blue[PPU.CGADD]);
 		}
 
 		PPU.CGADD++;
@@ -722,7 +735,7 @@ static inline void REGISTER_2122 (uint8 Byte)
 			IPPU.ColorsChanged = TRUE;
 			IPPU.Red[PPU.CGADD] = IPPU.XB[Byte & 0x1f];
 			IPPU.Green[PPU.CGADD] = IPPU.XB[(PPU.CGDATA[PPU.CGADD] >> 5) & 0x1f];
-			IPPU.ScreenColors[PPU.CGADD] = (uint16) BUILD_PIXEL(IPPU.Red[PPU.CGADD], IPPU.Green[PPU.CGADD], IPPU.Blue[PPU.CGADD]);
+			IPPU.ScreenColors[PPU.CGADD] = (pixel_t) BUILD_PIXEL(IPPU.Red[PPU.CGADD], IPPU.Green[PPU.CGADD], IPPU.Blue[PPU.CGADD]);
 		}
 	}
 
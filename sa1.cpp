@@ -195,6 +195,7 @@ void S9xSA1Init (void)
 	SA1.Waiting = FALSE;
 	SA1.Flags = 0;
 	SA1.Executing = FALSE;
+	SA1.Budget = 0;
 	memset(&Memory.FillRAM[0x2200], 0, 0x200);
 	Memory.FillRAM[0x2200] = 0x20;
 	Memory.FillRAM[0x2220] = 0x00;
@@ -788,61 +789,8 @@ static void S9xSA1CharConv2 (void)
 	uint8	*p             = &Memory.FillRAM[0x3000] + (dest & 0x7ff) + offset * bytes_per_char;
 	uint8	*q             = &Memory.ROM[CMemory::MAX_ROM_SIZE - 0x10000] + offset * 64;
 
-	switch (depth)
-	{
-		case 2:
-			for (int l = 0; l < 8; l++, q += 8)
-			{
-				for (int b = 0; b < 8; b++)
-				{
-					uint8	r = *(q + b);
-					*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-					*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-				}
-
-				p += 2;
-			}
-
-			break;
-
-		case 4:
-			for (int l = 0; l < 8; l++, q += 8)
-			{
-				for (int b = 0; b < 8; b++)
-				{
-					uint8	r = *(q + b);
-					*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-					*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-					*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-					*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-				}
-
-				p += 2;
-			}
-
-			break;
-
-		case 8:
-			for (int l = 0; l < 8; l++, q += 8)
-			{
-				for (int b = 0; b < 8; b++)
-				{
-					uint8	r = *(q + b);
-					*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-					*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-					*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-					*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-					*(p + 32) = (*(p + 32) << 1) | ((r >> 4) & 1);
-					*(p + 33) = (*(p + 33) << 1) | ((r >> 5) & 1);
-					*(p + 48) = (*(p + 48) << 1) | ((r >> 6) & 1);
-					*(p + 49) = (*(p + 49) << 1) | ((r >> 7) & 1);
-				}
-
-				p += 2;
-			}
-
-			break;
-	}
+	for (int l = 0; l < 8; l++, q += 8, p += 2)
+		S9xSA1PlanarRow(p, S9xSA1UnpackRow(q, 8), depth);
 }
 
 static void S9xSA1DMA (void)
@@ -919,7 +867,17 @@ static void S9xSA1ReadVariableLengthData (bool8 inc, bool8 no_shift)
 		s &= 15;
 	}
 
-	uint32	data = S9xSA1GetWord(addr) | (S9xSA1GetWord(addr + 2) << 16);
+	uint32	data;
+	uint8	*ptr = SA1.Map[(addr & 0xffffff) >> MEMMAP_SHIFT];
+
+	// Read the whole window at once unless it leaves the memory block
+	if (ptr >= (uint8 *) CMemory::MAP_LAST && (addr & MEMMAP_MASK) <= MEMMAP_BLOCK_SIZE - 4)
+	{
+		data = READ_DWORD(ptr + (addr & 0xffff));
+		SA1OpenBus = (uint8) (data >> 16);
+	}
+	else
+		data = S9xSA1GetWord(addr) | (S9xSA1GetWord(addr + 2) << 16);
 
 	data >>= s;
 	Memory.FillRAM[0x230c] = (uint8) data;
@@ -226,6 +226,7 @@ struct SSA1
 	int64	sum;
 	uint8	VirtualBitmapFormat;
 	uint8	variable_bit_pos;
+	int32	Budget;
 };
 
 #define SA1CheckCarry()		(SA1._Carry)
@@ -266,6 +267,62 @@ void S9xSA1MainLoop (void);
 void S9xSA1ExecuteDuringSleep (void);
 void S9xSA1PostLoadState (void);
 
+// The SA-1 runs this many instructions per S-CPU instruction, in bursts
+#define SA1_OPS_PER_CPU_OP	3
+
+// Let the SA-1 catch up before the S-CPU looks at anything it shares with it
+static inline void S9xSA1Sync (void)
+{
+	if (SA1.Budget > 0)
+		S9xSA1MainLoop();
+}
+
+// I-RAM ($00-$3F,$80-$BF:$3000-$37FF) and BW-RAM ($40-$4F) are direct-mapped, so the S-CPU checks the address itself
+static inline void S9xSA1SyncAddress (uint32 Address)
+{
+	if (SA1.Budget > 0 && ((Address & 0x40f800) == 0x003000 || (Address & 0xf00000) == 0x400000))
+		S9xSA1MainLoop();
+}
+
+#define SA1_U64(hi, lo)		(((uint64) (hi) << 32) | (uint32) (lo))
+
+// Writes one row of 8 pixels to the character planes. The row holds one pixel per byte, the leftmost pixel in
+// the bottom byte; bit k of every pixel is gathered into plane k's byte with one multiply.
+static inline void S9xSA1PlanarRow (uint8 *p, uint64 w, int depth)
+{
+	for (int k = 0; k < depth; k++)
+		p[((k >> 1) << 4) | (k & 1)] = (uint8) ((((w >> k) & SA1_U64(0x01010101, 0x01010101)) * SA1_U64(0x80402010, 0x08040201)) >> 56);
+}
+
+// Spreads a row of 8 packed pixels (leftmost pixel in the lowest bits) out to one pixel per byte
+static inline uint64 S9xSA1UnpackRow (const uint8 *q, int depth)
+{
+	uint64	w;
+
+	switch (depth)
+	{
+		case 2:
+			w = q[0] | (q[1] << 8);
+			w = (w | (w << 24)) & SA1_U64(0x000000ff, 0x000000ff);
+			w = (w | (w << 12)) & SA1_U64(0x000f000f, 0x000f000f);
+			w = (w | (w <<  6)) & SA1_U64(0x03030303, 0x03030303);
+			break;
+
+		case 4:
+			w = q[0] | (q[1] << 8) | (q[2] << 16) | ((uint32) q[3] << 24);
+			w = (w | (w << 16)) & SA1_U64(0x0000ffff, 0x0000ffff);
+			w = (w | (w <<  8)) & SA1_U64(0x00ff00ff, 0x00ff00ff);
+			w = (w | (w <<  4)) & SA1_U64(0x0f0f0f0f, 0x0f0f0f0f);
+			break;
+
+		default:
+			w = SA1_U64(q[4] | (q[5] << 8) | (q[6] << 16) | ((uint32) q[7] << 24), q[0] | (q[1] << 8) | (q[2] << 16) | ((uint32) q[3] << 24));
+			break;
+	}
+
+	return (w);
+}
+
 #define SNES_IRQ_SOURCE		(1 << 7)
 #define TIMER_IRQ_SOURCE	(1 << 6)
 #define DMA_IRQ_SOURCE		(1 << 5)
@@ -229,42 +229,50 @@
 
 void S9xSA1MainLoop (void)
 {
-	if (SA1.Flags & NMI_FLAG)
-	{
-		if (Memory.FillRAM[0x2200] & 0x10)
-		{
-			SA1.Flags &= ~NMI_FLAG;
-			Memory.FillRAM[0x2301] |= 0x10;
-
-			if (SA1.WaitingForInterrupt)
-			{
-				SA1.WaitingForInterrupt = FALSE;
-				SA1Registers.PCw++;
-			}
+	int32	budget = SA1.Budget;
 
-			S9xSA1Opcode_NMI();
-		}
-	}
+	SA1.Budget = 0;
 
-	if (SA1.Flags & IRQ_FLAG)
+	for (; budget > 0 && SA1.Executing; budget--)
 	{
-		if (SA1.IRQActive)
+		// Interrupts are taken at the start of each S-CPU instruction's share, as when the SA-1 ran in step
+		if (budget % SA1_OPS_PER_CPU_OP == 0 && (SA1.Flags & (NMI_FLAG | IRQ_FLAG)))
 		{
-			if (SA1.WaitingForInterrupt)
+			if (SA1.Flags & NMI_FLAG)
 			{
-				SA1.WaitingForInterrupt = FALSE;
-				SA1Registers.PCw++;
+				if (Memory.FillRAM[0x2200] & 0x10)
+				{
+					SA1.Flags &= ~NMI_FLAG;
+					Memory.FillRAM[0x2301] |= 0x10;
+
+					if (SA1.WaitingForInterrupt)
+					{
+						SA1.WaitingForInterrupt = FALSE;
+						SA1Registers.PCw++;
+					}
+
+					S9xSA1Opcode_NMI();
+				}
 			}
 
-			if (!SA1CheckFlag(IRQ))
-				S9xSA1Opcode_IRQ();
+			if (SA1.Flags & IRQ_FLAG)
+			{
+				if (SA1.IRQActive)
+				{
+					if (SA1.WaitingForInterrupt)
+					{
+						SA1.WaitingForInterrupt = FALSE;
+						SA1Registers.PCw++;
+					}
+
+					if (!SA1CheckFlag(IRQ))
+						S9xSA1Opcode_IRQ();
+				}
+				else
+					SA1.Flags &= ~IRQ_FLAG;
+			}
 		}
-		else
-			SA1.Flags &= ~IRQ_FLAG;
-	}
 
-	for (int i = 0; i < 3 && SA1.Executing; i++)
-	{
 	#ifdef DEBUGGER
 		if (SA1.Flags & TRACE_FLAG)
 			S9xSA1Trace();
@@ -254,9 +254,15 @@ bool8 S9xDoScreenshot (int width, int height)
 
 	png_set_IHDR(png_ptr, info_ptr, imgwidth, imgheight, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
+#ifdef GFX_XRGB8888
+	sig_bit.red   = 8;
+	sig_bit.green = 8;
+	sig_bit.blue  = 8;
+#else
 	sig_bit.red   = 5;
 	sig_bit.green = 5;
 	sig_bit.blue  = 5;
+#endif
 	png_set_sBIT(png_ptr, info_ptr, &sig_bit);
 	png_set_shift(png_ptr, &sig_bit);
 
@@ -265,7 +271,7 @@ bool8 S9xDoScreenshot (int width, int height)
 	png_set_packing(png_ptr);
 
 	png_byte	*row_pointer = new png_byte[png_get_rowbytes(png_ptr, info_ptr)];
-	uint16		*screen = GFX.Screen;
+	pixel_t		*screen = GFX.Screen;
 
 	for (int y = 0; y < height; y++, screen += GFX.RealPPL)
 	{
@@ -178,6 +178,7 @@
 #include "snes9x.h"
 #include "memmap.h"
 #include "sdd1.h"
+#include "sdd1emu.h"
 #include "display.h"
 
 
@@ -196,6 +197,8 @@ void S9xSetSDD1MemoryMap (uint32 bank, uint32 value)
 
 void S9xResetSDD1 (void)
 {
+	SDD1_flush_cache();
+
 	memset(&Memory.FillRAM[0x4800], 0, 4);
 	for (int i = 0; i < 4; i++)
 	{
@@ -501,3 +501,118 @@ uint8 SDD1_get_byte(void){
     }
 }
 #endif
+
+/* Cache of decompressed blocks.
+ *
+ * Games DMA the same compressed graphics over and over, and the output only
+ * depends on the input stream, so blocks read from ROM are kept keyed by their
+ * source address. The stream is decoded in order, so a shorter read of a
+ * cached block is a prefix of it and the mode bits come along with the data.
+ */
+
+#define SDD1_CACHE_BUCKETS		1024
+#define SDD1_CACHE_MAX_BYTES	(4 * 1024 * 1024)
+
+struct sdd1_cache_entry {
+    uint8 *in;
+    int len;
+    uint8 *data;
+    struct sdd1_cache_entry *hash_next;
+    struct sdd1_cache_entry *lru_prev, *lru_next;
+};
+
+static struct sdd1_cache_entry *cache_buckets[SDD1_CACHE_BUCKETS];
+static struct sdd1_cache_entry cache_lru; /* lru_next is the most recently used */
+static uint32 cache_bytes;
+static uint32 cache_hits;
+static uint32 cache_misses;
+
+static inline uint32 CacheHash(uint8 *in){
+    uint32 h=(uint32)(pint)in;
+
+    h^=h>>11;
+    h*=0x9e3779b1;
+    return h>>22;
+}
+
+static inline void CacheUnlink(struct sdd1_cache_entry *e){
+    e->lru_prev->lru_next=e->lru_next;
+    e->lru_next->lru_prev=e->lru_prev;
+}
+
+static inline void CacheLinkFront(struct sdd1_cache_entry *e){
+    e->lru_prev=&cache_lru;
+    e->lru_next=cache_lru.lru_next;
+    cache_lru.lru_next->lru_prev=e;
+    cache_lru.lru_next=e;
+}
+
+static void CacheRemove(struct sdd1_cache_entry *e){
+    struct sdd1_cache_entry **pp=&cache_buckets[CacheHash(e->in)];
+
+    while(*pp!=e) pp=&(*pp)->hash_next;
+    *pp=e->hash_next;
+    CacheUnlink(e);
+    cache_bytes-=e->len+sizeof(struct sdd1_cache_entry);
+    free(e->data);
+    free(e);
+}
+
+void SDD1_flush_cache(void){
+    if(!cache_lru.lru_next){
+        cache_lru.lru_next=cache_lru.lru_prev=&cache_lru;
+        return;
+    }
+    while(cache_lru.lru_next!=&cache_lru) CacheRemove(cache_lru.lru_next);
+    cache_hits=cache_misses=0;
+}
+
+void SDD1_cache_stats(uint32 *hits, uint32 *misses, uint32 *bytes){
+    *hits=cache_hits;
+    *misses=cache_misses;
+    *bytes=cache_bytes;
+}
+
+void SDD1_decompress_cached(uint8 *out, uint8 *in, int len){
+    struct sdd1_cache_entry *e;
+
+    if(len==0) len=0x10000;
+    if(!cache_lru.lru_next) SDD1_flush_cache();
+
+    for(e=cache_buckets[CacheHash(in)]; e; e=e->hash_next){
+        if(e->in==in) break;
+    }
+
+    if(e && e->len>=len){
+        memcpy(out, e->data, len);
+        CacheUnlink(e);
+        CacheLinkFront(e);
+        cache_hits++;
+        return;
+    }
+
+    cache_misses++;
+    SDD1_decompress(out, in, len);
+
+    /* a longer read of a cached block replaces it */
+    if(e) CacheRemove(e);
+
+    while(cache_lru.lru_prev!=&cache_lru &&
+          cache_bytes+len+sizeof(struct sdd1_cache_entry)>SDD1_CACHE_MAX_BYTES)
+        CacheRemove(cache_lru.lru_prev);
+
+    e=(struct sdd1_cache_entry *)malloc(sizeof(struct sdd1_cache_entry));
+    if(!e) return;
+    e->data=(uint8 *)malloc(len);
+    if(!e->data){
+        free(e);
+        return;
+    }
+    memcpy(e->data, out, len);
+    e->in=in;
+    e->len=len;
+    e->hash_next=cache_buckets[CacheHash(in)];
+    cache_buckets[CacheHash(in)]=e;
+    CacheLinkFront(e);
+    cache_bytes+=len+sizeof(struct sdd1_cache_entry);
+}
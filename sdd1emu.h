@@ -179,5 +179,8 @@
 #define _SDD1EMU_H_
 
 void SDD1_decompress (uint8 *, uint8 *, int);
+void SDD1_decompress_cached (uint8 *, uint8 *, int);
+void SDD1_flush_cache (void);
+void SDD1_cache_stats (uint32 *, uint32 *, uint32 *);
 
 #endif
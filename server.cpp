@@ -206,8 +206,10 @@
 	#include <sys/time.h>
 
 	#include <netdb.h>
+	#include <sys/ioctl.h>
 	#include <sys/socket.h>
 	#include <sys/param.h>
+	#include <sys/uio.h>
 	#include <netinet/in.h>
 	#include <arpa/inet.h>
 	#include <signal.h>
@@ -216,6 +218,11 @@
 		#include <sys/stropts.h>
 	#endif
 
+	#ifdef __linux__
+		#include <sys/epoll.h>
+		#define NP_USE_EPOLL 1
+	#endif
+
 #endif // !__WIN32__
 
 #include "snes9x.h"
@@ -229,25 +236,74 @@
 #define NP_ONE_CLIENT 0
 #endif
 
+#define NP_MAX_EVENTS 64
+#define NP_LISTEN_EVENT 0xffffffff
+
 struct SNPServer NPServer;
 
 extern unsigned long START;
 
-void S9xNPSendToAllClients (uint8 *data, int len);
+// The ROM image last sent, kept so every client shares one copy of it.
+static struct SNPBuffer *rom_image = NULL;
+static uint32 rom_image_crc32 = 0;
+
+void S9xNPSendToAllClients (const uint8 *header, int header_len,
+                            struct SNPBuffer *body = NULL);
 bool8 S9xNPLoadFreezeFile (const char *fname, uint8 *&data, uint32 &len);
-void S9xNPSendFreezeFile (int c, uint8 *data, uint32 len);
+void S9xNPSendFreezeFile (int c, struct SNPBuffer *freeze);
 void S9xNPNoClientReady (int start_index = NP_ONE_CLIENT);
 void S9xNPRecomputePause ();
 void S9xNPWaitForEmulationToComplete ();
 void S9xNPSendROMImageToAllClients ();
 bool8 S9xNPSendROMImageToClient (int client);
-void S9xNPSendSRAMToClient (int c);
+void S9xNPSendSRAMToClient (int c, struct SNPBuffer *sram = NULL);
 void S9xNPSendSRAMToAllClients ();
 void S9xNPSyncClient (int);
 void S9xNPSendROMLoadRequest (const char *filename);
 void S9xNPSendFreezeFileToAllClients (const char *filename);
 void S9xNPStopServer ();
 
+static inline bool8 S9xNPIsSpectator (int c)
+{
+    return (c >= NP_MAX_CLIENTS);
+}
+
+static struct SNPBuffer *S9xNPNewBuffer (uint8 *data, uint32 len)
+{
+    struct SNPBuffer *buffer = new struct SNPBuffer;
+
+    buffer->RefCount = 1;
+    buffer->Length = len;
+    buffer->Data = data;
+
+    return (buffer);
+}
+
+static void S9xNPReleaseBuffer (struct SNPBuffer *buffer)
+{
+    if (buffer && --buffer->RefCount == 0)
+    {
+        delete [] buffer->Data;
+        delete buffer;
+    }
+}
+
+static void S9xNPWatchWrites (int c, bool8 watch)
+{
+    if (NPServer.Clients [c].WantWrite == watch)
+        return;
+
+    NPServer.Clients [c].WantWrite = watch;
+#ifdef NP_USE_EPOLL
+    struct epoll_event event;
+
+    memset (&event, 0, sizeof (event));
+    event.events = watch ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.u32 = c;
+    epoll_ctl (NPServer.EpollFD, EPOLL_CTL_MOD, NPServer.Clients [c].Socket, &event);
+#endif
+}
+
 void S9xNPShutdownClient (int c, bool8 report_error = FALSE)
 {
     if (NPServer.Clients [c].Connected)
@@ -262,7 +318,8 @@ void S9xNPShutdownClient (int c, bool8 report_error = FALSE)
         if (report_error)
         {
             sprintf (NetPlay.ErrorMsg,
-                     "Player %d on '%s' has disconnected.", c + 1,
+                     "%s %d on '%s' has disconnected.",
+                     S9xNPIsSpectator (c) ? "Spectator" : "Player", c + 1,
                      NPServer.Clients [c].HostName);
             S9xNPSetWarning  (NetPlay.ErrorMsg);
         }
@@ -282,128 +339,178 @@ void S9xNPShutdownClient (int c, bool8 report_error = FALSE)
             free ((char *) NPServer.Clients [c].Who);
             NPServer.Clients [c].Who = NULL;
         }
-        NPServer.Joypads [c] = 0;
+        while (NPServer.Clients [c].SendHead)
+        {
+            struct SNPPacket *packet = NPServer.Clients [c].SendHead;
+
+            NPServer.Clients [c].SendHead = packet->Next;
+            S9xNPReleaseBuffer (packet->Body);
+            delete packet;
+        }
+        NPServer.Clients [c].SendTail = NULL;
+        NPServer.Clients [c].SendQueued = 0;
+        NPServer.Clients [c].WantWrite = FALSE;
+        delete [] NPServer.Clients [c].ReceiveBody;
+        NPServer.Clients [c].ReceiveBody = NULL;
+        NPServer.Clients [c].ReceiveGot = 0;
+        NPServer.Clients [c].ReceiveLength = 7;
+        if (!S9xNPIsSpectator (c))
+            NPServer.Joypads [c] = 0;
         NPServer.NumClients--;
         S9xNPRecomputePause ();
     }
 }
 
-static bool8 S9xNPSGetData (int socket, uint8 *data, int length)
+// Winsock reports socket errors through WSAGetLastError (), never errno.
+static bool8 S9xNPInterrupted ()
 {
-    int len = length;
-    uint8 *ptr = data;
-
-    do
-    {
-        int num_bytes = len;
-
-        // Read the data in small chunks, allowing this thread to spot an
-        // abort request from another thread.
-        if (num_bytes > 512)
-            num_bytes = 512;
+#ifdef __WIN32__
+    return (WSAGetLastError () == WSAEINTR);
+#else
+    return (errno == EINTR);
+#endif
+}
 
-        int got = read (socket, (char *) ptr, num_bytes);
-        if (got < 0)
-        {
-	    if (errno == EINTR
+static bool8 S9xNPWouldBlock ()
+{
+#ifdef __WIN32__
+    return (WSAGetLastError () == WSAEWOULDBLOCK);
+#else
+    return (0
 #ifdef EAGAIN
-		|| errno == EAGAIN
+            || errno == EAGAIN
 #endif
 #ifdef EWOULDBLOCK
-		|| errno == EWOULDBLOCK
+            || errno == EWOULDBLOCK
 #endif
-#ifdef WSAEWOULDBLOCK
-                || errno == WSAEWOULDBLOCK
+            );
 #endif
-		)
-		continue;
-#ifdef WSAEMSGSIZE
-            if (errno != WSAEMSGSIZE)
-                return (FALSE);
-            else
-            {
-                got = num_bytes;
-#ifdef NP_DEBUG
-                printf ("SERVER: WSAEMSGSIZE, actual bytes %d while receiving data @%d\n", got, S9xGetMilliTime () - START);
+}
+
+// Writes as much of the client's queue as its socket will take without
+// blocking. Whatever is left goes out when the socket becomes writable.
+static bool8 S9xNPSFlushClient (int c)
+{
+    struct SNPClient *client = &NPServer.Clients [c];
+
+    while (client->SendHead)
+    {
+        struct SNPPacket *packet = client->SendHead;
+        uint32 body_len = packet->Body ? packet->Body->Length : 0;
+        uint32 length = packet->HeaderLength + body_len;
+        int sent;
+
+#ifdef __WIN32__
+        if (packet->Sent < packet->HeaderLength)
+            sent = write (client->Socket, (char *) packet->Header + packet->Sent,
+                          packet->HeaderLength - packet->Sent);
+        else
+            sent = write (client->Socket, (char *) packet->Body->Data +
+                          packet->Sent - packet->HeaderLength, length - packet->Sent);
+#else
+        struct iovec iov [2];
+        int n = 0;
+
+        if (packet->Sent < packet->HeaderLength)
+        {
+            iov [n].iov_base = packet->Header + packet->Sent;
+            iov [n].iov_len = packet->HeaderLength - packet->Sent;
+            n++;
+        }
+        if (body_len > 0)
+        {
+            uint32 done = packet->Sent > packet->HeaderLength ?
+                          packet->Sent - packet->HeaderLength : 0;
+            iov [n].iov_base = packet->Body->Data + done;
+            iov [n].iov_len = body_len - done;
+            n++;
+        }
+        sent = writev (client->Socket, iov, n);
 #endif
+
+        if (sent < 0)
+        {
+            if (S9xNPInterrupted ())
+                continue;
+            if (S9xNPWouldBlock ())
+            {
+                S9xNPWatchWrites (c, TRUE);
+                return (TRUE);
             }
-#else
             return (FALSE);
-#endif
         }
         else
-        if (got == 0)
+        if (sent == 0)
             return (FALSE);
 
-        len -= got;
-        ptr += got;
-    } while (len > 0);
+        packet->Sent += sent;
+#ifdef __WIN32__
+        if (length > 1024)
+        {
+            int Percent = (uint8) (((uint64) packet->Sent * 100) / length);
+            PostMessage (GUI.hWnd, WM_USER, Percent, Percent);
+        }
+#endif
+        if (packet->Sent < length)
+            continue;
+
+        client->SendHead = packet->Next;
+        if (!client->SendHead)
+            client->SendTail = NULL;
+        client->SendQueued -= length;
+        S9xNPReleaseBuffer (packet->Body);
+        delete packet;
+    }
 
+    S9xNPWatchWrites (c, FALSE);
     return (TRUE);
 }
 
-static bool8 S9xNPSSendData (int fd, const uint8 *data, int length)
+// Queues a message for one client, stamping its sequence number into
+// header [1]. The body is shared, not copied; the queue holds a reference.
+// Fails if the client has stopped reading and its backlog is too large.
+static bool8 S9xNPSQueueData (int c, const uint8 *header, int header_len,
+                              struct SNPBuffer *body)
 {
-    int Percent = 0;
-    int len = length;
-    int chunk = length / 50;
-
-    if (chunk < 1024)
-        chunk = 1024;
+    struct SNPClient *client = &NPServer.Clients [c];
+    uint32 length = header_len + (body ? body->Length : 0);
 
-    do
+    if (client->SendQueued + length > NP_MAX_SEND_BACKLOG + Memory.CalculatedSize)
     {
-        int num_bytes = len;
+#ifdef NP_DEBUG
+        printf ("SERVER: Player %d send queue full, dropping @%ld\n", c + 1, S9xGetMilliTime () - START);
+#endif
+        return (FALSE);
+    }
 
-        // Write the data in small chunks, allowing this thread to spot an
-        // abort request from another thread.
-        if (num_bytes > chunk)
-            num_bytes = chunk;
+    struct SNPPacket *packet = new struct SNPPacket;
 
-	int sent;
-	sent = write (fd, (char *) data, len);
+    memcpy (packet->Header, header, header_len);
+    packet->Header [1] = client->SendSequenceNum++;
+    packet->HeaderLength = header_len;
+    packet->Sent = 0;
+    packet->Body = body;
+    packet->Next = NULL;
+    if (body)
+        body->RefCount++;
+    client->SendQueued += length;
 
-	if (sent < 0)
-	{
-	    if (errno == EINTR
-#ifdef EAGAIN
-		|| errno == EAGAIN
-#endif
-#ifdef EWOULDBLOCK
-		|| errno == EWOULDBLOCK
-#endif
-		)
-            {
-#ifdef NP_DEBUG
-                printf ("SERVER: EINTR, EAGAIN or EWOULDBLOCK while sending data @%ld\n", S9xGetMilliTime () - START);
-#endif
-		continue;
-            }
-	    return (FALSE);
-	}
-	else
-	if (sent == 0)
-	    return (FALSE);
-	len -= sent;
-	data += sent;
-        if (length > 1024)
-        {
-            Percent = (uint8) (((length - len) * 100) / length);
-#ifdef __WIN32__
-            PostMessage (GUI.hWnd, WM_USER, Percent, Percent);
-            Sleep (0);
-#endif
-        }
-    } while (len > 0);
+    if (client->SendTail)
+    {
+        // Still waiting for the socket; the flush will reach this one.
+        client->SendTail->Next = packet;
+        client->SendTail = packet;
+        return (TRUE);
+    }
 
-    return (TRUE);
+    client->SendHead = client->SendTail = packet;
+    return (S9xNPSFlushClient (c));
 }
 
 void S9xNPSendHeartBeat ()
 {
-    int len = 3;
-    uint8 data [3 + 4 * 5];
-    uint8 *ptr = data;
+    uint8 header [3];
+    uint8 *ptr;
     int n;
 
     for (n = NP_MAX_CLIENTS - 1; n >= 0; n--)
@@ -412,17 +519,27 @@ void S9xNPSendHeartBeat ()
             break;
     }
 
+    // Spectators still need the frame count with no players attached.
+    for (int c = NP_MAX_CLIENTS; n < 0 && c < NPServer.MaxClients; c++)
+    {
+        if (NPServer.Clients [c].SaidHello)
+            n = 0;
+    }
+
     if (n >= 0)
     {
         bool8 Paused = NPServer.Paused != 0;
+        struct SNPBuffer *body = S9xNPNewBuffer (new uint8 [4 + 4 * (n + 1)],
+                                                 4 + 4 * (n + 1));
 
         NPServer.FrameCount++;
+        ptr = header;
         *ptr++ = NP_SERV_MAGIC;
         *ptr++ = 0; // Individual client sequence number will get placed here
         *ptr++ = NP_SERV_JOYPAD | (n << 6) | ((Paused != 0) << 5);
 
+        ptr = body->Data;
         WRITE_LONG (ptr, NPServer.FrameCount);
-        len += 4;
         ptr += 4;
 
         int i;
@@ -430,42 +547,36 @@ void S9xNPSendHeartBeat ()
         for (i = 0; i <= n; i++)
         {
             WRITE_LONG (ptr, NPServer.Joypads [i]);
-            len += 4;
             ptr += 4;
         }
 
-        S9xNPSendToAllClients (data, len);
+        S9xNPSendToAllClients (header, 3, body);
+        S9xNPReleaseBuffer (body);
     }
 }
 
-void S9xNPSendToAllClients (uint8 *data, int len)
+void S9xNPSendToAllClients (const uint8 *header, int header_len,
+                            struct SNPBuffer *body)
 {
     int i;
 
-    for (i = 0; i < NP_MAX_CLIENTS; i++)
+    for (i = 0; i < NPServer.MaxClients; i++)
     {
-	if (NPServer.Clients [i].SaidHello)
-	{
-            data [1] = NPServer.Clients [i].SendSequenceNum++;
-	    if (!S9xNPSSendData (NPServer.Clients [i].Socket, data, len))
-		S9xNPShutdownClient (i, TRUE);
-	}
+        if (NPServer.Clients [i].SaidHello)
+        {
+            if (!S9xNPSQueueData (i, header, header_len, body))
+                S9xNPShutdownClient (i, TRUE);
+        }
     }
 }
 
-void S9xNPProcessClient (int c)
+void S9xNPProcessClient (int c, const uint8 *header, uint8 *data)
 {
-    uint8 header [7];
-    uint8 *data;
+    struct SNPBuffer *body;
+    uint8 reply [7];
     uint32 len;
     uint8 *ptr;
 
-    if (!S9xNPSGetData (NPServer.Clients [c].Socket, header, 7))
-    {
-        S9xNPSetWarning ("SERVER: Failed to get message header from client.\n");
-        S9xNPShutdownClient (c, TRUE);
-        return;
-    }
     if (header [0] != NP_CLNT_MAGIC)
     {
         S9xNPSetWarning ("SERVER: Bad header magic value received from client.\n");
@@ -503,19 +614,6 @@ void S9xNPProcessClient (int c)
             printf ("SERVER: Got HELLO from client @%ld\n", S9xGetMilliTime () - START);
 #endif
             S9xNPSetAction ("Got HELLO from client...", TRUE);
-            if (len > 0x10000)
-            {
-                S9xNPSetWarning ("SERVER: Client HELLO message length error.");
-                S9xNPShutdownClient (c, TRUE);
-                return;
-            }
-            data = new uint8 [len - 7];
-            if (!S9xNPSGetData (NPServer.Clients [c].Socket, data, len - 7))
-            {
-                S9xNPSetWarning ("SERVER: Failed to get HELLO message content from client.");
-                S9xNPShutdownClient (c, TRUE);
-                return;
-            }
 
             if (NPServer.NumClients <= NP_ONE_CLIENT)
             {
@@ -533,10 +631,9 @@ void S9xNPProcessClient (int c)
 
             len = 7 + 1 + 1 + 4 + strlen (NPServer.ROMName) + 1;
 
-            delete data;
-            ptr = data = new uint8 [len];
+            ptr = reply;
             *ptr++ = NP_SERV_MAGIC;
-            *ptr++ = NPServer.Clients [c].SendSequenceNum++;
+            *ptr++ = 0;
 
             if (NPServer.SendROMImageOnConnect &&
                 NPServer.NumClients > NP_ONE_CLIENT)
@@ -544,7 +641,9 @@ void S9xNPProcessClient (int c)
             else
                 *ptr++ = NP_SERV_HELLO;
             WRITE_LONG (ptr, len);
-            ptr += 4;
+
+            body = S9xNPNewBuffer (new uint8 [len - 7], len - 7);
+            ptr = body->Data;
             *ptr++ = NP_VERSION;
             *ptr++ = c + 1;
             WRITE_LONG (ptr, NPServer.FrameCount);
@@ -555,13 +654,14 @@ void S9xNPProcessClient (int c)
             printf ("SERVER: Sending welcome information to client @%ld...\n", S9xGetMilliTime () - START);
 #endif
             S9xNPSetAction ("SERVER: Sending welcome information to new client...", TRUE);
-            if (!S9xNPSSendData (NPServer.Clients [c].Socket, data, len))
+            if (!S9xNPSQueueData (c, reply, 7, body))
             {
+                S9xNPReleaseBuffer (body);
                 S9xNPSetWarning ("SERVER: Failed to send welcome message to client.");
                 S9xNPShutdownClient (c, TRUE);
                 return;
             }
-            delete data;
+            S9xNPReleaseBuffer (body);
 #ifdef NP_DEBUG
             printf ("SERVER: Waiting for a response from the client @%ld...\n", S9xGetMilliTime () - START);
 #endif
@@ -578,13 +678,13 @@ void S9xNPProcessClient (int c)
             S9xNPRecomputePause ();
             S9xNPWaitForEmulationToComplete ();
 
-            if (NPServer.SyncByReset)
+            if (NPServer.SyncByReset && !S9xNPIsSpectator (c))
             {
-                S9xNPServerAddTask (NP_SERVER_SEND_SRAM, (void *) c);
+                S9xNPServerAddTask (NP_SERVER_SEND_SRAM, (void *)(pint) c);
                 S9xNPServerAddTask (NP_SERVER_RESET_ALL, 0);
             }
             else
-                S9xNPServerAddTask (NP_SERVER_SYNC_CLIENT, (void *) c);
+                S9xNPServerAddTask (NP_SERVER_SYNC_CLIENT, (void *)(pint) c);
             break;
 
         case NP_CLNT_RECEIVED_ROM_IMAGE:
@@ -597,13 +697,13 @@ void S9xNPProcessClient (int c)
             S9xNPRecomputePause ();
             S9xNPWaitForEmulationToComplete ();
 
-            if (NPServer.SyncByReset)
+            if (NPServer.SyncByReset && !S9xNPIsSpectator (c))
             {
-                S9xNPServerAddTask (NP_SERVER_SEND_SRAM, (void *) c);
+                S9xNPServerAddTask (NP_SERVER_SEND_SRAM, (void *)(pint) c);
                 S9xNPServerAddTask (NP_SERVER_RESET_ALL, 0);
             }
             else
-                S9xNPServerAddTask (NP_SERVER_SYNC_CLIENT, (void *) c);
+                S9xNPServerAddTask (NP_SERVER_SYNC_CLIENT, (void *)(pint) c);
 
             break;
 
@@ -638,21 +738,27 @@ void S9xNPProcessClient (int c)
 //printf ("SERVER: SaidHello = TRUE, SeqNum = %d @%d\n", NPServer.Clients [c].SendSequenceNum, S9xGetMilliTime () - START);
             if (NPServer.NumClients > NP_ONE_CLIENT)
             {
+                if (S9xNPIsSpectator (c))
+                {
+                    /* A spectator only needs the game state; the players carry on */
+                    S9xNPServerAddTask (NP_SERVER_SYNC_CLIENT, (void *)(pint) c);
+                }
+                else
                 if (!NPServer.SendROMImageOnConnect)
                 {
                     S9xNPWaitForEmulationToComplete ();
 
                     if (NPServer.SyncByReset)
                     {
-                        S9xNPServerAddTask (NP_SERVER_SEND_SRAM, (void *) c);
+                        S9xNPServerAddTask (NP_SERVER_SEND_SRAM, (void *)(pint) c);
                         S9xNPServerAddTask (NP_SERVER_RESET_ALL, 0);
                     }
                     else
 #ifdef __WIN32__
-                        S9xNPServerAddTask (NP_SERVER_SYNC_CLIENT, (void *) c);
+                        S9xNPServerAddTask (NP_SERVER_SYNC_CLIENT, (void *)(pint) c);
 #else
                         /* We need to resync all clients on new player connect as we don't have a 'reference game' */
-                        S9xNPServerAddTask (NP_SERVER_SYNC_ALL, (void *) c);
+                        S9xNPServerAddTask (NP_SERVER_SYNC_ALL, (void *)(pint) c);
 #endif
                 }
             }
@@ -663,7 +769,8 @@ void S9xNPProcessClient (int c)
             }
             break;
         case NP_CLNT_JOYPAD:
-            NPServer.Joypads [c] = len;
+            if (!S9xNPIsSpectator (c))
+                NPServer.Joypads [c] = len;
             break;
         case NP_CLNT_PAUSE:
 #ifdef NP_DEBUG
@@ -680,6 +787,81 @@ void S9xNPProcessClient (int c)
     }
 }
 
+// Reads whatever the client has sent so far and processes each message as
+// soon as it is complete. Only HELLO carries data after the 7 byte header.
+void S9xNPReadClient (int c)
+{
+    struct SNPClient *client = &NPServer.Clients [c];
+
+    while (client->Connected)
+    {
+        uint8 *ptr;
+        int want;
+
+        if (client->ReceiveGot < 7)
+        {
+            ptr = client->ReceiveHeader + client->ReceiveGot;
+            want = 7 - client->ReceiveGot;
+        }
+        else
+        {
+            ptr = client->ReceiveBody + client->ReceiveGot - 7;
+            want = client->ReceiveLength - client->ReceiveGot;
+        }
+
+        int got = read (client->Socket, (char *) ptr, want);
+        if (got < 0)
+        {
+            if (S9xNPInterrupted ())
+                continue;
+            if (S9xNPWouldBlock ())
+                return;
+            S9xNPSetWarning ("SERVER: Failed to get message from client.\n");
+            S9xNPShutdownClient (c, TRUE);
+            return;
+        }
+        else
+        if (got == 0)
+        {
+            S9xNPShutdownClient (c, TRUE);
+            return;
+        }
+
+        client->ReceiveGot += got;
+
+        if (client->ReceiveGot == 7 &&
+            (client->ReceiveHeader [2] & 0x3f) == NP_CLNT_HELLO)
+        {
+            uint32 len = READ_LONG (&client->ReceiveHeader [3]);
+
+            if (len < 7 + 4 || len > 0x10000)
+            {
+                S9xNPSetWarning ("SERVER: Client HELLO message length error.");
+                S9xNPShutdownClient (c, TRUE);
+                return;
+            }
+            // One spare byte keeps the ROM name terminated.
+            client->ReceiveLength = len;
+            client->ReceiveBody = new uint8 [len - 7 + 1];
+            client->ReceiveBody [len - 7] = 0;
+        }
+
+        if (client->ReceiveGot == client->ReceiveLength)
+        {
+            uint8 header [7];
+            uint8 *data = client->ReceiveBody;
+
+            memcpy (header, client->ReceiveHeader, 7);
+            client->ReceiveBody = NULL;
+            client->ReceiveGot = 0;
+            client->ReceiveLength = 7;
+
+            S9xNPProcessClient (c, header, data);
+            delete [] data;
+        }
+    }
+}
+
 void S9xNPAcceptClient (int Listen, bool8 block)
 {
     struct sockaddr_in remote_address;
@@ -687,6 +869,11 @@ void S9xNPAcceptClient (int Listen, bool8 block)
     struct hostent *host;
     int new_fd;
     int i;
+#ifdef __WIN32__
+    unsigned long nonblock = 1;
+#else
+    int nonblock = 1;
+#endif
 
 #ifdef NP_DEBUG
     printf ("SERVER: attempting to accept new client connection @%ld\n", S9xGetMilliTime () - START);
@@ -701,17 +888,31 @@ void S9xNPAcceptClient (int Listen, bool8 block)
     val2.l_onoff = 1;
     val2.l_linger = 0;
     if (setsockopt (new_fd, SOL_SOCKET, SO_LINGER,
-		    (char *) &val2, sizeof (val2)) < 0)
+		    (char *) &val2, sizeof (val2)) < 0 ||
+        ioctl (new_fd, FIONBIO, &nonblock) < 0)
     {
         S9xNPSetError ("Setting socket options failed.");
 	close (new_fd);
         return;
     }
 
-    for (i = 0; i < NP_MAX_CLIENTS; i++)
+    for (i = 0; i < NPServer.MaxClients; i++)
     {
 	if (!NPServer.Clients [i].Connected)
 	{
+#ifdef NP_USE_EPOLL
+            struct epoll_event event;
+
+            memset (&event, 0, sizeof (event));
+            event.events = EPOLLIN;
+            event.data.u32 = i;
+            if (epoll_ctl (NPServer.EpollFD, EPOLL_CTL_ADD, new_fd, &event) < 0)
+            {
+                S9xNPSetError ("SERVER: Can't watch new client connection.");
+                close (new_fd);
+                return;
+            }
+#endif
             NPServer.NumClients++;
 	    NPServer.Clients [i].Socket = new_fd;
             NPServer.Clients [i].SendSequenceNum = 0;
@@ -723,17 +924,26 @@ void S9xNPAcceptClient (int Listen, bool8 block)
             NPServer.Clients [i].ROMName = NULL;
             NPServer.Clients [i].HostName = NULL;
             NPServer.Clients [i].Who = NULL;
+            NPServer.Clients [i].SendHead = NULL;
+            NPServer.Clients [i].SendTail = NULL;
+            NPServer.Clients [i].SendQueued = 0;
+            NPServer.Clients [i].WantWrite = FALSE;
+            NPServer.Clients [i].ReceiveGot = 0;
+            NPServer.Clients [i].ReceiveLength = 7;
+            NPServer.Clients [i].ReceiveBody = NULL;
 	    break;
 	}
     }
 
-    if (i >= NP_MAX_CLIENTS)
+    if (i >= NPServer.MaxClients)
     {
         S9xNPSetError ("SERVER: Maximum number of NetPlay Clients have already connected.");
 	close (new_fd);
 	return;
     }
 
+    const char *kind = S9xNPIsSpectator (i) ? "Spectator" : "Player";
+
     if (remote_address.sin_family == AF_INET)
     {
 #ifdef NP_DEBUG
@@ -748,7 +958,7 @@ void S9xNPAcceptClient (int Listen, bool8 block)
 #ifdef NP_DEBUG
             printf ("SERVER: resolved new client's hostname (%s) @%ld\n", host->h_name, S9xGetMilliTime () - START);
 #endif
-	    sprintf (NetPlay.WarningMsg, "SERVER: Player %d on %s has connected.", i + 1, host->h_name);
+	    sprintf (NetPlay.WarningMsg, "SERVER: %s %d on %s has connected.", kind, i + 1, host->h_name);
 	    NPServer.Clients [i].HostName = strdup (host->h_name);
 	}
         else
@@ -759,7 +969,7 @@ void S9xNPAcceptClient (int Listen, bool8 block)
 #ifdef NP_DEBUG
             printf ("SERVER: couldn't resolve new client's hostname (%s) @%ld\n", ip ? ip : "Unknown", S9xGetMilliTime () - START);
 #endif
-	    sprintf (NetPlay.WarningMsg, "SERVER: Player %d on %s has connected.", i + 1, ip ? ip : "Unknown");
+	    sprintf (NetPlay.WarningMsg, "SERVER: %s %d on %s has connected.", kind, i + 1, ip ? ip : "Unknown");
         }
         S9xNPSetWarning (NetPlay.WarningMsg);
     }
@@ -780,7 +990,23 @@ static bool8 S9xNPServerInit (int port)
     if (!S9xNPInitialise ())
         return (FALSE);
 
-    for (i = 0; i < NP_MAX_CLIENTS; i++)
+    // The first NP_MAX_CLIENTS connections are players, the rest spectate.
+    val = Settings.NetPlayMaxClients;
+    if (val < NP_MAX_CLIENTS)
+        val = NP_MAX_CLIENTS;
+    if (val > NP_MAX_CONNECTIONS)
+        val = NP_MAX_CONNECTIONS;
+
+    if (NPServer.Clients && NPServer.MaxClients != val)
+    {
+        delete [] NPServer.Clients;
+        NPServer.Clients = NULL;
+    }
+    if (!NPServer.Clients)
+        NPServer.Clients = new struct SNPClient [val];
+    NPServer.MaxClients = val;
+
+    for (i = 0; i < NPServer.MaxClients; i++)
     {
         NPServer.Clients [i].SendSequenceNum = 0;
         NPServer.Clients [i].ReceiveSequenceNum = 0;
@@ -792,8 +1018,16 @@ static bool8 S9xNPServerInit (int port)
         NPServer.Clients [i].ROMName = NULL;
         NPServer.Clients [i].HostName = NULL;
         NPServer.Clients [i].Who = NULL;
-        NPServer.Joypads [i] = 0;
+        NPServer.Clients [i].SendHead = NULL;
+        NPServer.Clients [i].SendTail = NULL;
+        NPServer.Clients [i].SendQueued = 0;
+        NPServer.Clients [i].WantWrite = FALSE;
+        NPServer.Clients [i].ReceiveGot = 0;
+        NPServer.Clients [i].ReceiveLength = 7;
+        NPServer.Clients [i].ReceiveBody = NULL;
     }
+    for (i = 0; i < NP_MAX_CLIENTS; i++)
+        NPServer.Joypads [i] = 0;
 
     NPServer.NumClients = 0;
     NPServer.FrameCount = 0;
@@ -828,12 +1062,26 @@ static bool8 S9xNPServerInit (int port)
 #ifdef NP_DEBUG
     printf ("SERVER: Getting socket to listen @%ld\n", S9xGetMilliTime () - START);
 #endif
-    if (listen (NPServer.Socket, NP_MAX_CLIENTS) < 0)
+    if (listen (NPServer.Socket, NPServer.MaxClients) < 0)
     {
 	S9xNPSetError ("NetPlay Server: Can't get new socket to listen.");
 	return (FALSE);
     }
 
+#ifdef NP_USE_EPOLL
+    struct epoll_event event;
+
+    memset (&event, 0, sizeof (event));
+    event.events = EPOLLIN;
+    event.data.u32 = NP_LISTEN_EVENT;
+    if ((NPServer.EpollFD = epoll_create (NPServer.MaxClients + 1)) < 0 ||
+        epoll_ctl (NPServer.EpollFD, EPOLL_CTL_ADD, NPServer.Socket, &event) < 0)
+    {
+	S9xNPSetError ("NetPlay Server: Can't watch listening socket.");
+	return (FALSE);
+    }
+#endif
+
 #ifdef NP_DEBUG
     printf ("SERVER: Init complete @%ld\n", S9xGetMilliTime () - START);
 #endif
@@ -854,6 +1102,86 @@ void S9xNPSendServerPause (bool8 paused)
     S9xNPSendToAllClients (pause, 7);
 }
 
+// Waits up to timeout_ms for socket activity and services it: new
+// connections, incoming messages and sockets ready to take queued data.
+// Returns the number of sockets that were ready.
+static int S9xNPPollSockets (int timeout_ms)
+{
+#ifdef NP_USE_EPOLL
+    struct epoll_event events [NP_MAX_EVENTS];
+    int res;
+    int e;
+
+    res = epoll_wait (NPServer.EpollFD, events, NP_MAX_EVENTS, timeout_ms);
+
+    for (e = 0; e < res; e++)
+    {
+        uint32 c = events [e].data.u32;
+
+        if (c == NP_LISTEN_EVENT)
+        {
+            S9xNPAcceptClient (NPServer.Socket, FALSE);
+            continue;
+        }
+
+        if (events [e].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+            S9xNPReadClient (c);
+
+        if (NPServer.Clients [c].Connected && (events [e].events & EPOLLOUT) &&
+            !S9xNPSFlushClient (c))
+            S9xNPShutdownClient (c, TRUE);
+    }
+
+    return (res);
+#else
+    fd_set read_fds;
+    fd_set write_fds;
+    struct timeval timeout;
+    int max_fd = NPServer.Socket;
+    int res;
+    int i;
+
+    FD_ZERO (&read_fds);
+    FD_ZERO (&write_fds);
+    FD_SET (NPServer.Socket, &read_fds);
+    for (i = 0; i < NPServer.MaxClients; i++)
+    {
+        if (NPServer.Clients [i].Connected)
+        {
+            FD_SET (NPServer.Clients [i].Socket, &read_fds);
+            if (NPServer.Clients [i].SendHead)
+                FD_SET (NPServer.Clients [i].Socket, &write_fds);
+            if (NPServer.Clients [i].Socket > max_fd)
+                max_fd = NPServer.Clients [i].Socket;
+        }
+    }
+
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    res = select (max_fd + 1, &read_fds, &write_fds, NULL, &timeout);
+
+    if (res > 0)
+    {
+        if (FD_ISSET (NPServer.Socket, &read_fds))
+            S9xNPAcceptClient (NPServer.Socket, FALSE);
+
+        for (i = 0; i < NPServer.MaxClients; i++)
+        {
+            if (NPServer.Clients [i].Connected &&
+                FD_ISSET (NPServer.Clients [i].Socket, &read_fds))
+                S9xNPReadClient (i);
+
+            if (NPServer.Clients [i].Connected &&
+                FD_ISSET (NPServer.Clients [i].Socket, &write_fds) &&
+                !S9xNPSFlushClient (i))
+                S9xNPShutdownClient (i, TRUE);
+        }
+    }
+
+    return (res);
+#endif
+}
+
 void S9xNPServerLoop (void *)
 {
 #ifdef __WIN32__
@@ -868,12 +1196,7 @@ void S9xNPServerLoop (void *)
 
     while (server_continue)
     {
-        fd_set read_fds;
-        struct timeval timeout;
         int res;
-        int i;
-
-        int max_fd = NPServer.Socket;
 
 #ifdef __WIN32__
         Sleep (0);
@@ -898,36 +1221,7 @@ void S9xNPServerLoop (void *)
 
         do
         {
-            FD_ZERO (&read_fds);
-            FD_SET (NPServer.Socket, &read_fds);
-            for (i = 0; i < NP_MAX_CLIENTS; i++)
-            {
-                if (NPServer.Clients [i].Connected)
-                {
-                    FD_SET (NPServer.Clients [i].Socket, &read_fds);
-                    if (NPServer.Clients [i].Socket > max_fd)
-                        max_fd = NPServer.Clients [i].Socket;
-                }
-            }
-
-            timeout.tv_sec = 0;
-            timeout.tv_usec = 1000;
-            res = select (max_fd + 1, &read_fds, NULL, NULL, &timeout);
-
-            if (res > 0)
-            {
-                if (FD_ISSET (NPServer.Socket, &read_fds))
-                    S9xNPAcceptClient (NPServer.Socket, FALSE);
-
-                for (i = 0; i < NP_MAX_CLIENTS; i++)
-                {
-                    if (NPServer.Clients [i].Connected &&
-                        FD_ISSET (NPServer.Clients [i].Socket, &read_fds))
-                    {
-                        S9xNPProcessClient (i);
-                    }
-                }
-            }
+            res = S9xNPPollSockets (1);
         } while (res > 0);
 
 #ifdef __WIN32__
@@ -942,11 +1236,12 @@ void S9xNPServerLoop (void *)
 
 	if (timercmp(&next1, &now, >))
         {
-            /* If we're ahead of time, sleep a while */
+            /* If we're ahead of time, keep the sockets moving while we wait */
             unsigned timeleft =
                 (next1.tv_sec - now.tv_sec) * 1000000
                 + next1.tv_usec - now.tv_usec;
-	    usleep(timeleft<(200*1000)?timeleft:(200*1000));
+	    S9xNPPollSockets ((timeleft<(200*1000)?timeleft:(200*1000)) / 1000);
+            while (gettimeofday (&now, NULL) < 0) ;
         }
 
         if (!timercmp(&next1, &now, >))
@@ -1035,6 +1330,8 @@ void S9xNPServerLoop (void *)
 #ifdef NP_DEBUG
     printf ("SERVER: Server thread exiting @%ld\n", S9xGetMilliTime () - START);
 #endif
+    S9xNPReleaseBuffer (rom_image);
+    rom_image = NULL;
     // OV2: S9xNPStopServer has already been called if we get here
     // S9xNPStopServer ();
 }
@@ -1067,11 +1364,14 @@ void S9xNPStopServer ()
     server_continue = FALSE;
     close (NPServer.Socket);
 
-    for (int i = 0; i < NP_MAX_CLIENTS; i++)
+    for (int i = 0; i < NPServer.MaxClients; i++)
     {
         if (NPServer.Clients [i].Connected)
 	    S9xNPShutdownClient(i, FALSE);
     }
+#ifdef NP_USE_EPOLL
+    close (NPServer.EpollFD);
+#endif
 }
 
 #ifdef __WIN32__
@@ -1091,7 +1391,7 @@ void S9xNPSendROMImageToAllClients ()
 
     int c;
 
-    for (c = NP_ONE_CLIENT; c < NP_MAX_CLIENTS; c++)
+    for (c = NP_ONE_CLIENT; c < NPServer.MaxClients; c++)
     {
         if (NPServer.Clients [c].SaidHello)
             S9xNPSendROMImageToClient (c);
@@ -1114,23 +1414,30 @@ bool8 S9xNPSendROMImageToClient (int c)
     sprintf (NetPlay.ActionMsg, "Sending ROM image to player %d...", c + 1);
     S9xNPSetAction (NetPlay.ActionMsg, TRUE);
 
+    uint32 image_len = Memory.CalculatedSize + strlen (Memory.ROMFilename) + 1;
+
+    if (!rom_image || rom_image_crc32 != Memory.ROMCRC32 ||
+        rom_image->Length != image_len)
+    {
+        S9xNPReleaseBuffer (rom_image);
+        rom_image = S9xNPNewBuffer (new uint8 [image_len], image_len);
+        memmove (rom_image->Data, Memory.ROM, Memory.CalculatedSize);
+        strcpy ((char *) rom_image->Data + Memory.CalculatedSize, Memory.ROMFilename);
+        rom_image_crc32 = Memory.ROMCRC32;
+    }
+
     uint8 header [7 + 1 + 4];
     uint8 *ptr = header;
-    int len = sizeof (header) + Memory.CalculatedSize +
-              strlen (Memory.ROMFilename) + 1;
+    int len = sizeof (header) + image_len;
     *ptr++ = NP_SERV_MAGIC;
-    *ptr++ = NPServer.Clients [c].SendSequenceNum++;
+    *ptr++ = 0;
     *ptr++ = NP_SERV_ROM_IMAGE;
     WRITE_LONG (ptr, len);
     ptr += 4;
     *ptr++ = Memory.HiROM;
     WRITE_LONG (ptr, Memory.CalculatedSize);
 
-    if (!S9xNPSSendData (NPServer.Clients [c].Socket, header, sizeof (header)) ||
-        !S9xNPSSendData (NPServer.Clients [c].Socket, Memory.ROM,
-                        Memory.CalculatedSize) ||
-        !S9xNPSSendData (NPServer.Clients [c].Socket, (uint8 *) Memory.ROMFilename,
-                        strlen (Memory.ROMFilename) + 1))
+    if (!S9xNPSQueueData (c, header, sizeof (header), rom_image))
     {
         S9xNPShutdownClient (c, TRUE);
         return (FALSE);
@@ -1146,56 +1453,37 @@ void S9xNPSyncClients ()
 
 void S9xNPSyncClient (int client)
 {
-#ifdef HAVE_MKSTEMP
-    char fname[] = "/tmp/snes9x_fztmpXXXXXX";
-    int fd=-1;
-#else
-    char fname [L_tmpnam];
-#endif
+    uint8 *data;
+    uint32 len;
 
     S9xNPWaitForEmulationToComplete ();
 
     S9xNPSetAction ("SERVER: Freezing game...", TRUE);
-#ifdef HAVE_MKSTEMP
-    if ( ((fd=mkstemp(fname)) >= 0) && S9xFreezeGame(fname) )
-#else
-    if ( tmpnam(fname) && S9xFreezeGame(fname) )
-#endif
+    if (S9xFreezeGameMem (&data, &len))
     {
-        uint8 *data;
-        uint32 len;
+        struct SNPBuffer *freeze = S9xNPNewBuffer (data, len);
+        int c;
 
-        S9xNPSetAction ("SERVER: Loading freeze file...", TRUE);
-        if (S9xNPLoadFreezeFile (fname, data, len))
+        if (client < 0)
         {
-            int c;
-
-            if (client < 0)
+            for (c = NP_ONE_CLIENT; c < NPServer.MaxClients; c++)
             {
-                for (c = NP_ONE_CLIENT; c < NP_MAX_CLIENTS; c++)
+                if (NPServer.Clients [c].SaidHello)
                 {
-                    if (NPServer.Clients [c].SaidHello)
-                    {
-                        NPServer.Clients [c].Ready = FALSE;
-                        S9xNPRecomputePause ();
-                        S9xNPSendFreezeFile (c, data, len);
-                    }
+                    NPServer.Clients [c].Ready = FALSE;
+                    S9xNPRecomputePause ();
+                    S9xNPSendFreezeFile (c, freeze);
                 }
             }
-            else
-            {
-                NPServer.Clients [client].Ready = FALSE;
-                S9xNPRecomputePause ();
-                S9xNPSendFreezeFile (client, data, len);
-            }
-            delete data;
         }
-        remove (fname);
+        else
+        {
+            NPServer.Clients [client].Ready = FALSE;
+            S9xNPRecomputePause ();
+            S9xNPSendFreezeFile (client, freeze);
+        }
+        S9xNPReleaseBuffer (freeze);
     }
-#ifdef HAVE_MKSTEMP
-    if (fd != -1)
-        close(fd);
-#endif
 }
 
 bool8 S9xNPLoadFreezeFile (const char *fname, uint8 *&data, uint32 &len)
@@ -1212,12 +1500,14 @@ bool8 S9xNPLoadFreezeFile (const char *fname, uint8 *&data, uint32 &len)
         bool8 ok = (fread (data, 1, len, ff) == len);
         fclose (ff);
 
+        if (!ok)
+            delete [] data;
         return (ok);
     }
     return (FALSE);
 }
 
-void S9xNPSendFreezeFile (int c, uint8 *data, uint32 len)
+void S9xNPSendFreezeFile (int c, struct SNPBuffer *freeze)
 {
 #ifdef NP_DEBUG
     printf ("SERVER: Sending freeze file to player %d @%ld\n", c + 1, S9xGetMilliTime () - START);
@@ -1229,20 +1519,20 @@ void S9xNPSendFreezeFile (int c, uint8 *data, uint32 len)
     uint8 *ptr = header;
 
     *ptr++ = NP_SERV_MAGIC;
-    *ptr++ = NPServer.Clients [c].SendSequenceNum++;
+    *ptr++ = 0;
     *ptr++ = NP_SERV_FREEZE_FILE;
-    WRITE_LONG (ptr, len + 7 + 4);
+    WRITE_LONG (ptr, freeze->Length + 7 + 4);
     ptr += 4;
     WRITE_LONG (ptr, NPServer.FrameCount);
 
-    if (!S9xNPSSendData (NPServer.Clients [c].Socket, header, 7 + 4) ||
-        !S9xNPSSendData (NPServer.Clients [c].Socket, data, len))
+    if (!S9xNPSQueueData (c, header, 7 + 4, freeze))
     {
        S9xNPShutdownClient (c, TRUE);
     }
     S9xNPSetAction ("", TRUE);
 }
 
+// Spectators neither hold up nor pause the session.
 void S9xNPRecomputePause ()
 {
     int c;
@@ -1269,7 +1559,7 @@ void S9xNPNoClientReady (int start_index)
 {
     int c;
 
-    for (c = start_index; c < NP_MAX_CLIENTS; c++)
+    for (c = start_index; c < NPServer.MaxClients; c++)
         NPServer.Clients [c].Ready = FALSE;
     S9xNPRecomputePause ();
 }
@@ -1279,16 +1569,17 @@ void S9xNPSendROMLoadRequest (const char *filename)
     S9xNPNoClientReady ();
 
     int len = 7 + strlen (filename) + 1;
-    uint8 *data = new uint8 [len];
-    uint8 *ptr = data;
+    uint8 header [7];
+    uint8 *ptr = header;
     *ptr++ = NP_SERV_MAGIC;
     *ptr++ = 0;
     *ptr++ = NP_SERV_LOAD_ROM;
     WRITE_LONG (ptr, len);
-    ptr += 4;
-    strcpy ((char *) ptr, filename);
 
-    for (int i = NP_ONE_CLIENT; i < NP_MAX_CLIENTS; i++)
+    struct SNPBuffer *name = S9xNPNewBuffer (new uint8 [len - 7], len - 7);
+    strcpy ((char *) name->Data, filename);
+
+    for (int i = NP_ONE_CLIENT; i < NPServer.MaxClients; i++)
     {
 	if (NPServer.Clients [i].SaidHello)
 	{
@@ -1297,55 +1588,68 @@ void S9xNPSendROMLoadRequest (const char *filename)
 #endif
             sprintf (NetPlay.WarningMsg, "SERVER: sending ROM load request to player %d...", i + 1);
             S9xNPSetAction (NetPlay.WarningMsg, TRUE);
-            data [1] = NPServer.Clients [i].SendSequenceNum++;
-	    if (!S9xNPSSendData (NPServer.Clients [i].Socket, data, len))
+	    if (!S9xNPSQueueData (i, header, 7, name))
             {
 		S9xNPShutdownClient (i, TRUE);
             }
         }
     }
-    delete data;
+    S9xNPReleaseBuffer (name);
+}
+
+// S-RAM is copied once per send so it can't change while still queued.
+static struct SNPBuffer *S9xNPSRAMBuffer ()
+{
+    int SRAMSize = Memory.SRAMSize ?
+                   (1 << (Memory.SRAMSize + 3)) * 128 : 0;
+    if (SRAMSize > 0x10000)
+        SRAMSize = 0x10000;
+
+    struct SNPBuffer *sram = S9xNPNewBuffer (new uint8 [SRAMSize], SRAMSize);
+    memmove (sram->Data, Memory.SRAM, SRAMSize);
+
+    return (sram);
 }
 
 void S9xNPSendSRAMToAllClients ()
 {
+    struct SNPBuffer *sram = S9xNPSRAMBuffer ();
     int i;
 
-    for (i = NP_ONE_CLIENT; i < NP_MAX_CLIENTS; i++)
+    for (i = NP_ONE_CLIENT; i < NPServer.MaxClients; i++)
     {
         if (NPServer.Clients [i].SaidHello)
-            S9xNPSendSRAMToClient (i);
+            S9xNPSendSRAMToClient (i, sram);
     }
+    S9xNPReleaseBuffer (sram);
 }
 
-void S9xNPSendSRAMToClient (int c)
+void S9xNPSendSRAMToClient (int c, struct SNPBuffer *sram)
 {
 #ifdef NP_DEBUG
     printf ("SERVER: Sending S-RAM data to player %d @%ld\n", c + 1, S9xGetMilliTime () - START);
 #endif
-    uint8 sram [7];
-    int SRAMSize = Memory.SRAMSize ?
-                   (1 << (Memory.SRAMSize + 3)) * 128 : 0;
-    if (SRAMSize > 0x10000)
-        SRAMSize = 0x10000;
-    int len = 7 + SRAMSize;
+    uint8 header [7];
+    bool8 own = (sram == NULL);
+
+    if (own)
+        sram = S9xNPSRAMBuffer ();
+    int len = 7 + sram->Length;
 
     sprintf (NetPlay.ActionMsg, "SERVER: Sending S-RAM to player %d...", c + 1);
     S9xNPSetAction (NetPlay.ActionMsg, TRUE);
 
-    uint8 *ptr = sram;
+    uint8 *ptr = header;
     *ptr++ = NP_SERV_MAGIC;
-    *ptr++ = NPServer.Clients [c].SendSequenceNum++;
+    *ptr++ = 0;
     *ptr++ = NP_SERV_SRAM_DATA;
     WRITE_LONG (ptr, len);
-    if (!S9xNPSSendData (NPServer.Clients [c].Socket,
-                        sram, sizeof (sram)) ||
-        (len > 7 &&
-         !S9xNPSSendData (NPServer.Clients [c].Socket,
-                         Memory.SRAM, len - 7)))
+    if (!S9xNPSQueueData (c, header, sizeof (header), sram))
     {
         S9xNPShutdownClient (c, TRUE);
     }
+    if (own)
+        S9xNPReleaseBuffer (sram);
 }
 
 void S9xNPSendFreezeFileToAllClients (const char *filename)
@@ -1355,14 +1659,16 @@ void S9xNPSendFreezeFileToAllClients (const char *filename)
 
     if (NPServer.NumClients > NP_ONE_CLIENT && S9xNPLoadFreezeFile (filename, data, len))
     {
+        struct SNPBuffer *freeze = S9xNPNewBuffer (data, len);
+
         S9xNPNoClientReady ();
 
-        for (int c = NP_ONE_CLIENT; c < NP_MAX_CLIENTS; c++)
+        for (int c = NP_ONE_CLIENT; c < NPServer.MaxClients; c++)
         {
             if (NPServer.Clients [c].SaidHello)
-                S9xNPSendFreezeFile (c, data, len);
+                S9xNPSendFreezeFile (c, freeze);
         }
-        delete data;
+        S9xNPReleaseBuffer (freeze);
     }
 }
 
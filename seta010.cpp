@@ -584,10 +584,14 @@ void S9xSetST010 (uint32 Address, uint8 Byte)
 				int32	offset = 0;
 				int16	Theta = ST010_WORD(0x0000);
 
+				// the angle is the same for every line
+				int16	Cos = ST010_Cos(Theta);
+				int16	Sin = ST010_Sin(Theta);
+
 				for (int32 line = 0; line < 176; line++)
 				{
 					// Calculate Mode 7 Matrix A/D data
-					data = ST010_M7Scale[line] * ST010_Cos(Theta) >> 15;
+					data = ST010_M7Scale[line] * Cos >> 15;
 
 					Memory.SRAM[0x00f0 + offset] = (uint8) (data);
 					Memory.SRAM[0x00f1 + offset] = (uint8) (data >> 8);
@@ -595,7 +599,7 @@ void S9xSetST010 (uint32 Address, uint8 Byte)
 					Memory.SRAM[0x0511 + offset] = (uint8) (data >> 8);
 
 					// Calculate Mode 7 Matrix B/C data
-					data = ST010_M7Scale[line] * ST010_Sin(Theta) >> 15;
+					data = ST010_M7Scale[line] * Sin >> 15;
 
 					Memory.SRAM[0x0250 + offset] = (uint8) (data);
 					Memory.SRAM[0x0251 + offset] = (uint8) (data >> 8);
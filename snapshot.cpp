@@ -189,6 +189,10 @@
 #include "movie.h"
 #include "display.h"
 #include "language.h"
+#ifdef USE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #ifndef min
 #define min(a,b)	(((a) < (b)) ? (a) : (b))
@@ -1128,13 +1132,142 @@ static FreezeData	SnapMovie[] =
 	INT_ENTRY(6, MovieInputDataSize)
 };
 
+// Snapshot codecs. All of them produce something gzread() can load, so states
+// written with any codec load through the usual STREAM path.
+
+#define FREEZE_SEGMENT_MIN	0x8000
+#define FREEZE_MAX_CUTS		32
+#define FREEZE_MAX_THREADS	8
+
+struct SnapshotCodecInfo
+{
+	const char	*name;
+	int			level;
+};
+
+static const struct SnapshotCodecInfo	SnapshotCodecs[] =
+{
+	{ "default", -1 },	// Z_DEFAULT_COMPRESSION
+	{ "fast",     1 },
+	{ "best",     9 },
+	{ "none",     0 }
+};
+
+// Memory buffer the freeze functions write to instead of the STREAM while
+// S9xFreezeGameMem is running. cuts[] holds the offsets at which the large blocks start.
+
+typedef struct
+{
+	uint8	*data;
+	uint32	size;
+	uint32	used;
+	int		num_cuts;
+	uint32	cuts[FREEZE_MAX_CUTS];
+}	SFreezeBuffer;
+
+static SFreezeBuffer	*FreezeMem = NULL;
+
+// Memory the unfreeze functions read from instead of the STREAM while
+// S9xUnfreezeGameMem is running. Gzip states are inflated into UnfreezeInflated first,
+// which is kept between loads like the staging area.
+
+typedef struct
+{
+	const uint8	*data;
+	uint32		size;
+	uint32		pos;
+}	SUnfreezeBuffer;
+
+static SUnfreezeBuffer	*UnfreezeMem = NULL;
+static uint8			*UnfreezeInflated     = NULL;
+static uint32			UnfreezeInflatedSize = 0;
+
+// Loading reads every block into one staging area before anything is applied.
+// It is sized once for the largest snapshot and kept between loads.
+// A block header that turns out to belong to a later block is held in
+// UnfreezeNext, so absent blocks don't seek the (gzip) stream backwards.
+
+static uint8	*UnfreezeStaging     = NULL;
+static uint32	UnfreezeStagingSize = 0;
+static uint32	UnfreezeStagingUsed = 0;
+static char		UnfreezeNext[12];
+static int		UnfreezeNextLen = 0;
+
+static const struct
+{
+	FreezeData	*fields;
+	int			num_fields;
+}	UnfreezeStructs[] =
+{
+	{ SnapCPU,          COUNT(SnapCPU)          },
+	{ SnapRegisters,    COUNT(SnapRegisters)    },
+	{ SnapPPU,          COUNT(SnapPPU)          },
+	{ SnapDMA,          COUNT(SnapDMA)          },
+	{ SnapControls,     COUNT(SnapControls)     },
+	{ SnapTimings,      COUNT(SnapTimings)      },
+	{ SnapFX,           COUNT(SnapFX)           },
+	{ SnapSA1,          COUNT(SnapSA1)          },
+	{ SnapSA1Registers, COUNT(SnapSA1Registers) },
+	{ SnapDSP1,         COUNT(SnapDSP1)         },
+	{ SnapDSP2,         COUNT(SnapDSP2)         },
+	{ SnapDSP4,         COUNT(SnapDSP4)         },
+	{ SnapST010,        COUNT(SnapST010)        },
+	{ SnapOBC1,         COUNT(SnapOBC1)         },
+	{ SnapSPC7110Snap,  COUNT(SnapSPC7110Snap)  },
+	{ SnapSRTCSnap,     COUNT(SnapSRTCSnap)     },
+	{ SnapBSX,          COUNT(SnapBSX)          },
+	{ SnapScreenshot,   COUNT(SnapScreenshot)   },
+	{ SnapMovie,        COUNT(SnapMovie)        }
+};
+
+// VRA, RAM, SRA, FIL, SND, CX4, OBM and CLK
+#define UNFREEZE_BLOCKS_SIZE	(0x10000 + 0x20000 + 0x20000 + 0x8000 + SPC_SAVE_STATE_BLOCK_SIZE + 8192 + 8192 + 20)
+
+#ifdef ZLIB
+typedef struct
+{
+	const uint8	*src;
+	uint32		len;
+	uint32		dict;
+	int			level;
+	bool8		last;
+	bool8		ok;
+	uint8		*out;
+	uint32		out_len;
+	uLong		crc;
+}	SFreezeSegment;
+
+typedef struct
+{
+	SFreezeSegment	*segs;
+	int				num_segs;
+	int				next;
+#ifdef USE_THREADS
+	pthread_mutex_t	mutex;
+#endif
+}	SFreezeJob;
+#endif
+
 static int UnfreezeBlock (STREAM, const char *, uint8 *, int);
 static int UnfreezeBlockCopy (STREAM, const char *, uint8 **, int);
 static int UnfreezeStruct (STREAM, const char *, void *, FreezeData *, int, int);
 static int UnfreezeStructCopy (STREAM, const char *, uint8 **, FreezeData *, int, int);
 static void UnfreezeStructFromCopy (void *, FreezeData *, int, uint8 *, int);
+static int FreezeSize (int, int);
+static void UnfreezeStagingReset (void);
+static int UnfreezeRead (STREAM, void *, int);
+#ifdef ZLIB
+static bool8 UnfreezeInflate (const uint8 *, uint32, uint32 *);
+#endif
+static void FreezeWrite (STREAM, const void *, int);
 static void FreezeBlock (STREAM, const char *, uint8 *, int);
 static void FreezeStruct (STREAM, const char *, void *, FreezeData *, int);
+static void FreezeState (STREAM);
+#ifdef ZLIB
+static void FreezeCompressSegment (SFreezeSegment *);
+static void * FreezeCompressWorker (void *);
+static bool8 FreezeCompressGzip (SFreezeBuffer *, uint8 **, uint32 *);
+#endif
 
 
 void S9xResetSaveTimer (bool8 dontsave)
@@ -1253,6 +1386,87 @@ bool8 S9xUnfreezeGame (const char *filename)
 }
 
 void S9xFreezeToStream (STREAM stream)
+{
+#ifdef ZLIB
+	// leave the level the port opened the stream with alone unless asked otherwise
+	if (Settings.SnapshotCompression != SNAPSHOT_CODEC_DEFAULT && Settings.SnapshotCompression < COUNT(SnapshotCodecs))
+		gzsetparams(stream, SnapshotCodecs[Settings.SnapshotCompression].level, Z_DEFAULT_STRATEGY);
+#endif
+
+	FreezeState(stream);
+}
+
+// Freezes into a new[]'d buffer holding exactly what S9xFreezeGame() would write to a file.
+// The large blocks are deflated on worker threads as pieces of one gzip stream.
+
+bool8 S9xFreezeGameMem (uint8 **data, uint32 *size)
+{
+	SFreezeBuffer	out;
+
+	memset(&out, 0, sizeof(out));
+	out.size = 0x80000;
+	out.data = new uint8[out.size];
+
+	FreezeMem = &out;
+	FreezeState(NULL);
+	FreezeMem = NULL;
+
+#ifdef ZLIB
+	if (Settings.SnapshotCompression != SNAPSHOT_CODEC_NONE)
+	{
+		bool8	ok = FreezeCompressGzip(&out, data, size);
+		delete [] out.data;
+		return (ok);
+	}
+#endif
+
+	// uncompressed states are read back transparently by gzread()
+	*data = out.data;
+	*size = out.used;
+
+	return (TRUE);
+}
+
+// Loads a state held in memory, such as one from S9xFreezeGameMem(), without going through a file.
+
+int S9xUnfreezeGameMem (const uint8 *data, uint32 size)
+{
+	SUnfreezeBuffer	in;
+	int				result;
+
+	in.data = data;
+	in.size = size;
+	in.pos  = 0;
+
+#ifdef ZLIB
+	if (size >= 2 && data[0] == 0x1f && data[1] == 0x8b)
+	{
+		if (!UnfreezeInflate(data, size, &in.size))
+			return (WRONG_FORMAT);
+
+		in.data = UnfreezeInflated;
+	}
+#endif
+
+	UnfreezeMem = &in;
+	result = S9xUnfreezeFromStream(NULL);
+	UnfreezeMem = NULL;
+
+	return (result);
+}
+
+int S9xSnapshotCodec (const char *name)
+{
+	for (int i = 0; i < (int) COUNT(SnapshotCodecs); i++)
+	{
+		if (!strcasecmp(name, SnapshotCodecs[i].name))
+			return (i);
+	}
+
+	return (SNAPSHOT_CODEC_DEFAULT);
+}
+
+static void FreezeState (STREAM stream)
 {
 	char	buffer[1024];
 	uint8 *soundsnapshot = new uint8[SPC_SAVE_STATE_BLOCK_SIZE];
@@ -1265,10 +1479,10 @@ void S9xFreezeToStream (STREAM stream)
 #endif
 
 	sprintf(buffer, "%s:%04d\n", SNAPSHOT_MAGIC, SNAPSHOT_VERSION);
-	WRITE_STREAM(buffer, strlen(buffer), stream);
+	FreezeWrite(stream, buffer, strlen(buffer));
 
 	sprintf(buffer, "NAM:%06d:%s%c", (int) strlen(Memory.ROMFilename) + 1, Memory.ROMFilename, 0);
-	WRITE_STREAM(buffer, strlen(buffer) + 1, stream);
+	FreezeWrite(stream, buffer, strlen(buffer) + 1);
 
 	FreezeStruct(stream, "CPU", &CPU, SnapCPU, COUNT(SnapCPU));
 
@@ -1289,6 +1503,8 @@ void S9xFreezeToStream (STREAM stream)
 
 	FreezeBlock (stream, "FIL", Memory.FillRAM, 0x8000);
 
+	// the APU state doesn't fill the whole block, keep the rest from carrying heap garbage
+	memset(soundsnapshot, 0, SPC_SAVE_STATE_BLOCK_SIZE);
 	S9xAPUSaveState(soundsnapshot);
 	FreezeBlock (stream, "SND", soundsnapshot, SPC_SAVE_STATE_BLOCK_SIZE);
 
@@ -1365,7 +1581,7 @@ void S9xFreezeToStream (STREAM stream)
 		ssi->Interlaced = GFX.DoInterlace;
 
 		uint8	*rowpix = ssi->Data;
-		uint16	*screen = GFX.Screen;
+		pixel_t	*screen = GFX.Screen;
 
 		for (int y = 0; y < ssi->Height; y++, screen += GFX.RealPPL)
 		{
@@ -1373,7 +1589,7 @@ void S9xFreezeToStream (STREAM stream)
 			{
 				uint32	r, g, b;
 
-				DECOMPOSE_PIXEL(screen[x], r, g, b);
+				DECOMPOSE_PIXEL5(screen[x], r, g, b);
 				*(rowpix++) = r;
 				*(rowpix++) = g;
 				*(rowpix++) = b;
@@ -1422,7 +1638,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 	char	buffer[PATH_MAX + 1];
 
 	len = strlen(SNAPSHOT_MAGIC) + 1 + 4 + 1;
-	if (READ_STREAM(buffer, len, stream) != len)
+	if (UnfreezeRead(stream, buffer, len) != len)
 		return (WRONG_FORMAT);
 
 	if (strncmp(buffer, SNAPSHOT_MAGIC, strlen(SNAPSHOT_MAGIC)) != 0)
@@ -1432,6 +1648,8 @@ int S9xUnfreezeFromStream (STREAM stream)
 	if (version > SNAPSHOT_VERSION)
 		return (WRONG_VERSION);
 
+	UnfreezeStagingReset();
+
 	result = UnfreezeBlock(stream, "NAM", (uint8 *) buffer, PATH_MAX);
 	if (result != SUCCESS)
 		return (result);
@@ -1583,9 +1801,14 @@ int S9xUnfreezeFromStream (STREAM stream)
 		}
 		else
 		{
-			result = UnfreezeBlockCopy(stream, "MID", &local_movie_data, mi.MovieInputDataSize);
+			local_movie_data = new uint8[mi.MovieInputDataSize];
+
+			result = UnfreezeBlock(stream, "MID", local_movie_data, mi.MovieInputDataSize);
 			if (result != SUCCESS)
 			{
+				delete [] local_movie_data;
+				local_movie_data = NULL;
+
 				if (S9xMovieActive())
 				{
 					result = NOT_A_MOVIE_SNAPSHOT;
@@ -1764,7 +1987,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 			GFX.DoInterlace = Settings.SupportHiRes ? ssi->Interlaced : 0;
 
 			uint8	*rowpix = ssi->Data;
-			uint16	*screen = GFX.Screen;
+			pixel_t	*screen = GFX.Screen;
 
 			for (int y = 0; y < IPPU.RenderedScreenHeight; y++, screen += GFX.RealPPL)
 			{
@@ -1786,7 +2009,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 							break;
 					}
 
-					screen[x] = BUILD_PIXEL(r, g, b);
+					screen[x] = BUILD_PIXEL5(r, g, b);
 				}
 
 				if (scaleDownY)
@@ -1799,7 +2022,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 
 			// black out what we might have missed
 			for (uint32 y = IPPU.RenderedScreenHeight; y < (uint32) (IMAGE_HEIGHT); y++)
-				memset(GFX.Screen + y * GFX.RealPPL, 0, GFX.RealPPL * 2);
+				memset(GFX.Screen + y * GFX.RealPPL, 0, GFX.RealPPL * sizeof(pixel_t));
 
 			delete ssi;
 		}
@@ -1807,39 +2030,14 @@ int S9xUnfreezeFromStream (STREAM stream)
 		{
 			// couldn't load graphics, so black out the screen instead
 			for (uint32 y = 0; y < (uint32) (IMAGE_HEIGHT); y++)
-				memset(GFX.Screen + y * GFX.RealPPL, 0, GFX.RealPPL * 2);
+				memset(GFX.Screen + y * GFX.RealPPL, 0, GFX.RealPPL * sizeof(pixel_t));
 		}
 
 		S9xSetSoundMute(FALSE);
 	}
 
-	if (local_cpu)				delete [] local_cpu;
-	if (local_registers)		delete [] local_registers;
-	if (local_ppu)				delete [] local_ppu;
-	if (local_dma)				delete [] local_dma;
-	if (local_vram)				delete [] local_vram;
-	if (local_ram)				delete [] local_ram;
-	if (local_sram)				delete [] local_sram;
-	if (local_fillram)			delete [] local_fillram;
-	if (local_apu_sound)		delete [] local_apu_sound;
-	if (local_control_data)		delete [] local_control_data;
-	if (local_timing_data)		delete [] local_timing_data;
-	if (local_superfx)			delete [] local_superfx;
-	if (local_sa1)				delete [] local_sa1;
-	if (local_sa1_registers)	delete [] local_sa1_registers;
-	if (local_dsp1)				delete [] local_dsp1;
-	if (local_dsp2)				delete [] local_dsp2;
-	if (local_dsp4)				delete [] local_dsp4;
-	if (local_cx4_data)			delete [] local_cx4_data;
-	if (local_st010)			delete [] local_st010;
-	if (local_obc1)				delete [] local_obc1;
-	if (local_obc1_data)		delete [] local_obc1_data;
-	if (local_spc7110)			delete [] local_spc7110;
-	if (local_srtc)				delete [] local_srtc;
-	if (local_rtc_data)			delete [] local_rtc_data;
-	if (local_bsx_data)			delete [] local_bsx_data;
-	if (local_screenshot)		delete [] local_screenshot;
-	if (local_movie_data)		delete [] local_movie_data;
+	if (local_movie_data)
+		delete [] local_movie_data;
 
 	return (result);
 }
@@ -2002,24 +2200,231 @@ static void FreezeBlock (STREAM stream, const char *name, uint8 *block, int size
 
 	buffer[11] = 0;
 
-	WRITE_STREAM(buffer, 11, stream);
-	WRITE_STREAM(block, size, stream);
+	FreezeWrite(stream, buffer, 11);
+	FreezeWrite(stream, block, size);
+}
+
+static void FreezeWrite (STREAM stream, const void *data, int size)
+{
+	SFreezeBuffer	*out = FreezeMem;
+
+	if (!out)
+	{
+		WRITE_STREAM(data, size, stream);
+		return;
+	}
+
+	if (out->used + size > out->size)
+	{
+		uint32	newsize = out->size * 2;
+		while (out->used + size > newsize)
+			newsize *= 2;
+
+		uint8	*newdata = new uint8[newsize];
+		memcpy(newdata, out->data, out->used);
+		delete [] out->data;
+
+		out->data = newdata;
+		out->size = newsize;
+	}
+
+	// large blocks start a new piece to be compressed by S9xFreezeGameMem
+	if (size >= FREEZE_SEGMENT_MIN && out->num_cuts < FREEZE_MAX_CUTS)
+		out->cuts[out->num_cuts++] = out->used;
+
+	memcpy(out->data + out->used, data, size);
+	out->used += size;
+}
+
+#ifdef ZLIB
+
+// Deflates one piece of the state as raw deflate data ending on a byte boundary (or the
+// final block for the last piece), primed with the 32KB in front of it, so the pieces
+// concatenate into a single stream that decodes like one written by gzwrite().
+
+static void FreezeCompressSegment (SFreezeSegment *seg)
+{
+	z_stream	z;
+
+	memset(&z, 0, sizeof(z));
+	seg->ok = FALSE;
+	seg->crc = crc32(crc32(0L, Z_NULL, 0), seg->src, seg->len);
+
+	if (deflateInit2(&z, seg->level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return;
+
+	if (seg->dict)
+		deflateSetDictionary(&z, seg->src - seg->dict, seg->dict);
+
+	seg->out_len = deflateBound(&z, seg->len) + 16;
+	seg->out = new uint8[seg->out_len];
+
+	z.next_in   = (Bytef *) seg->src;
+	z.avail_in  = seg->len;
+	z.next_out  = seg->out;
+	z.avail_out = seg->out_len;
+
+	int	r = deflate(&z, seg->last ? Z_FINISH : Z_SYNC_FLUSH);
+	if (seg->last)
+		seg->ok = (r == Z_STREAM_END);
+	else
+		seg->ok = (r == Z_OK && z.avail_in == 0 && z.avail_out != 0);
+
+	seg->out_len = z.total_out;
+	deflateEnd(&z);
+}
+
+static void * FreezeCompressWorker (void *arg)
+{
+	SFreezeJob	*job = (SFreezeJob *) arg;
+
+	for (;;)
+	{
+#ifdef USE_THREADS
+		pthread_mutex_lock(&job->mutex);
+#endif
+		int	i = job->next++;
+#ifdef USE_THREADS
+		pthread_mutex_unlock(&job->mutex);
+#endif
+
+		if (i >= job->num_segs)
+			break;
+
+		FreezeCompressSegment(&job->segs[i]);
+	}
+
+	return (NULL);
+}
+
+static bool8 FreezeCompressGzip (SFreezeBuffer *out, uint8 **data, uint32 *size)
+{
+	SFreezeSegment	segs[FREEZE_MAX_CUTS + 1];
+	SFreezeJob		job;
+	uint32			start = 0;
+	int				num_segs = 0, i;
+	int				codec = Settings.SnapshotCompression;
+
+	if (codec >= (int) COUNT(SnapshotCodecs))
+		codec = SNAPSHOT_CODEC_DEFAULT;
+
+	memset(segs, 0, sizeof(segs));
+
+	for (i = 0; i <= out->num_cuts; i++)
+	{
+		uint32	end = (i < out->num_cuts) ? out->cuts[i] : out->used;
+		if (end == start)
+			continue;
+
+		segs[num_segs].src   = out->data + start;
+		segs[num_segs].len   = end - start;
+		segs[num_segs].dict  = min(start, 0x8000);
+		segs[num_segs].level = SnapshotCodecs[codec].level;
+		num_segs++;
+
+		start = end;
+	}
+
+	if (num_segs == 0)
+		return (FALSE);
+
+	segs[num_segs - 1].last = TRUE;
+
+	job.segs     = segs;
+	job.num_segs = num_segs;
+	job.next     = 0;
+
+#ifdef USE_THREADS
+	pthread_t	threads[FREEZE_MAX_THREADS];
+	int			num_threads = (int) sysconf(_SC_NPROCESSORS_ONLN) - 1;
+
+	if (num_threads > FREEZE_MAX_THREADS)
+		num_threads = FREEZE_MAX_THREADS;
+	if (num_threads > num_segs - 1)
+		num_threads = num_segs - 1;
+
+	pthread_mutex_init(&job.mutex, NULL);
+
+	for (i = 0; i < num_threads; i++)
+	{
+		if (pthread_create(&threads[i], NULL, FreezeCompressWorker, &job) != 0)
+			break;
+	}
+
+	num_threads = i;
+#endif
+
+	FreezeCompressWorker(&job);
+
+#ifdef USE_THREADS
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_mutex_destroy(&job.mutex);
+#endif
+
+	bool8	ok  = TRUE;
+	uint32	len = 10 + 8;
+	uLong	crc = crc32(0L, Z_NULL, 0);
+
+	for (i = 0; i < num_segs; i++)
+	{
+		ok &= segs[i].ok;
+		len += segs[i].out_len;
+		crc = crc32_combine(crc, segs[i].crc, segs[i].len);
+	}
+
+	if (ok)
+	{
+		static const uint8	header[10] = { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 3 };
+		uint8	*ptr = *data = new uint8[len];
+
+		memcpy(ptr, header, 10);
+		ptr += 10;
+
+		for (i = 0; i < num_segs; i++)
+		{
+			memcpy(ptr, segs[i].out, segs[i].out_len);
+			ptr += segs[i].out_len;
+		}
+
+		WRITE_DWORD(ptr, (uint32) crc);
+		WRITE_DWORD(ptr + 4, out->used);
+
+		*size = len;
+	}
+
+	for (i = 0; i < num_segs; i++)
+		delete [] segs[i].out;
+
+	return (ok);
 }
 
+#endif
+
 static int UnfreezeBlock (STREAM stream, const char *name, uint8 *block, int size)
 {
 	char	buffer[20];
 	int		len = 0, rem = 0;
-	long	rewind = FIND_STREAM(stream);
+	size_t	l;
+
+	if (UnfreezeNextLen)
+	{
+		l = UnfreezeNextLen;
+		memcpy(buffer, UnfreezeNext, l);
+		UnfreezeNextLen = 0;
+	}
+	else
+		l = UnfreezeRead(stream, buffer, 11);
 
-	size_t	l = READ_STREAM(buffer, 11, stream);
 	buffer[l] = 0;
 
 	if (l != 11 || strncmp(buffer, name, 3) != 0 || buffer[3] != ':')
 	{
 	err:
 		fprintf(stdout, "absent: %s(%d); next: '%.11s'\n", name, size, buffer);
-		REVERT_STREAM(stream, FIND_STREAM(stream) - l, 0);
+		memcpy(UnfreezeNext, buffer, l);
+		UnfreezeNextLen = l;
 		return (WRONG_FORMAT);
 	}
 
@@ -2042,24 +2447,21 @@ static int UnfreezeBlock (STREAM stream, const char *name, uint8 *block, int siz
 		len = size;
 	}
 
-	ZeroMemory(block, size);
-
-	if (READ_STREAM(block, len, stream) != len)
-	{
-		REVERT_STREAM(stream, rewind, 0);
+	if (UnfreezeRead(stream, block, len) != len)
 		return (WRONG_FORMAT);
-	}
 
-	if (rem)
+	if (len < size)
+		ZeroMemory(block + len, size - len);
+
+	while (rem)
 	{
-		char	*junk = new char[rem];
-		len = READ_STREAM(junk, rem, stream);
-		delete [] junk;
-		if (len != rem)
-		{
-			REVERT_STREAM(stream, rewind, 0);
+		char	junk[1024];
+		int		n = min(rem, (int) sizeof(junk));
+
+		if (UnfreezeRead(stream, junk, n) != n)
 			return (WRONG_FORMAT);
-		}
+
+		rem -= n;
 	}
 
 	return (SUCCESS);
@@ -2069,16 +2471,20 @@ static int UnfreezeBlockCopy (STREAM stream, const char *name, uint8 **block, in
 {
 	int	result;
 
-	*block = new uint8[size];
+	if (UnfreezeStagingUsed + size > UnfreezeStagingSize)
+		return (WRONG_FORMAT);
+
+	*block = UnfreezeStaging + UnfreezeStagingUsed;
 
 	result = UnfreezeBlock(stream, name, *block, size);
 	if (result != SUCCESS)
 	{
-		delete [] (*block);
 		*block = NULL;
 		return (result);
 	}
 
+	UnfreezeStagingUsed += size;
+
 	return (SUCCESS);
 }
 
@@ -2089,14 +2495,9 @@ static int UnfreezeStruct (STREAM stream, const char *name, void *base, FreezeDa
 
 	result = UnfreezeStructCopy(stream, name, &block, fields, num_fields, version);
 	if (result != SUCCESS)
-	{
-		if (block != NULL)
-			delete [] block;
 		return (result);
-	}
 
 	UnfreezeStructFromCopy(base, fields, num_fields, block, version);
-	delete [] block;
 
 	return (SUCCESS);
 }
@@ -2114,6 +2515,85 @@ static int UnfreezeStructCopy (STREAM stream, const char *name, uint8 **block, F
 	return (UnfreezeBlockCopy(stream, name, block, len));
 }
 
+static int UnfreezeRead (STREAM stream, void *data, int size)
+{
+	SUnfreezeBuffer	*in = UnfreezeMem;
+
+	if (!in)
+		return (READ_STREAM(data, size, stream));
+
+	if (size > (int) (in->size - in->pos))
+		size = in->size - in->pos;
+
+	memcpy(data, in->data + in->pos, size);
+	in->pos += size;
+
+	return (size);
+}
+
+#ifdef ZLIB
+
+// Inflates a gzip state into UnfreezeInflated, growing it as needed.
+static bool8 UnfreezeInflate (const uint8 *data, uint32 size, uint32 *out_size)
+{
+	z_stream	z;
+	int			r;
+
+	memset(&z, 0, sizeof(z));
+	if (inflateInit2(&z, 16 + MAX_WBITS) != Z_OK)
+		return (FALSE);
+
+	if (!UnfreezeInflated)
+	{
+		UnfreezeInflatedSize = 0x80000;
+		UnfreezeInflated = new uint8[UnfreezeInflatedSize];
+	}
+
+	z.next_in   = (Bytef *) data;
+	z.avail_in  = size;
+	z.next_out  = UnfreezeInflated;
+	z.avail_out = UnfreezeInflatedSize;
+
+	while ((r = inflate(&z, Z_NO_FLUSH)) == Z_OK && z.avail_out == 0)
+	{
+		uint8	*newdata = new uint8[UnfreezeInflatedSize * 2];
+		memcpy(newdata, UnfreezeInflated, UnfreezeInflatedSize);
+		delete [] UnfreezeInflated;
+
+		UnfreezeInflated = newdata;
+		z.next_out  = UnfreezeInflated + UnfreezeInflatedSize;
+		z.avail_out = UnfreezeInflatedSize;
+		UnfreezeInflatedSize *= 2;
+	}
+
+	*out_size = z.total_out;
+	inflateEnd(&z);
+
+	return (r == Z_STREAM_END);
+}
+
+#endif
+
+static void UnfreezeStagingReset (void)
+{
+	UnfreezeStagingUsed = 0;
+	UnfreezeNextLen = 0;
+
+	if (UnfreezeStaging)
+		return;
+
+	// room for every block, counting the fields of all versions
+	UnfreezeStagingSize = UNFREEZE_BLOCKS_SIZE;
+
+	for (int i = 0; i < (int) COUNT(UnfreezeStructs); i++)
+	{
+		for (int j = 0; j < UnfreezeStructs[i].num_fields; j++)
+			UnfreezeStagingSize += FreezeSize(UnfreezeStructs[i].fields[j].size, UnfreezeStructs[i].fields[j].type);
+	}
+
+	UnfreezeStaging = new uint8[UnfreezeStagingSize];
+}
+
 static void UnfreezeStructFromCopy (void *sbase, FreezeData *fields, int num_fields, uint8 *block, int version)
 {
 	uint8	*ptr = block;
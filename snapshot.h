@@ -189,11 +189,23 @@
 #define NOT_A_MOVIE_SNAPSHOT	(-5)
 #define SNAPSHOT_INCONSISTENT	(-6)
 
+// Settings.SnapshotCompression
+enum
+{
+	SNAPSHOT_CODEC_DEFAULT,
+	SNAPSHOT_CODEC_FAST,
+	SNAPSHOT_CODEC_BEST,
+	SNAPSHOT_CODEC_NONE
+};
+
 void S9xResetSaveTimer (bool8);
 bool8 S9xFreezeGame (const char *);
 bool8 S9xUnfreezeGame (const char *);
 void S9xFreezeToStream (STREAM);
+bool8 S9xFreezeGameMem (uint8 **, uint32 *);
 int	 S9xUnfreezeFromStream (STREAM);
+int	 S9xUnfreezeGameMem (const uint8 *, uint32);
 bool8 S9xSPCDump (const char *);
+int	 S9xSnapshotCodec (const char *);
 
 #endif
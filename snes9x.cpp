@@ -188,6 +188,7 @@
 #include "cheats.h"
 #include "display.h"
 #include "conffile.h"
+#include "snapshot.h"
 #ifdef NETPLAY_SUPPORT
 #include "netplay.h"
 #endif
@@ -426,8 +427,10 @@ void S9xLoadConfigFiles (char **argv, int argc)
 	Settings.MovieTruncate              =  conf.GetBool("Settings::MovieTruncateAtEnd",        false);
 	Settings.MovieNotifyIgnored         =  conf.GetBool("Settings::MovieNotifyIgnored",        false);
 	Settings.WrongMovieStateProtection  =  conf.GetBool("Settings::WrongMovieStateProtection", true);
+	Settings.MovieKeyframeInterval      =  conf.GetUInt("Settings::MovieKeyframeInterval",     0);
 	Settings.StretchScreenshots         =  conf.GetInt ("Settings::StretchScreenshots",        1);
 	Settings.SnapshotScreenshots        =  conf.GetBool("Settings::SnapshotScreenshots",       true);
+	Settings.SnapshotCompression        =  S9xSnapshotCodec(conf.GetString("Settings::SnapshotCompression", "default"));
 	Settings.DontSaveOopsSnapshot       =  conf.GetBool("Settings::DontSaveOopsSnapshot",      false);
 	Settings.AutoSaveDelay              =  conf.GetUInt("Settings::AutoSaveDelay",             0);
 
@@ -484,6 +487,8 @@ void S9xLoadConfigFiles (char **argv, int argc)
 	Settings.ServerName[0] = '\0';
 	if (conf.Exists("Netplay::Server"))
 		conf.GetString("Netplay::Server", Settings.ServerName, 128);
+
+	Settings.NetPlayMaxClients = conf.GetUInt("Netplay::MaxClients", NP_MAX_CLIENTS);
 #endif
 
 	// Debug
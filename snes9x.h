@@ -398,11 +398,12 @@ struct SSettings
 	bool8	DisplayMovieFrame;
 	bool8	AutoDisplayMessages;
 	uint32	InitialInfoStringTimeout;
-	uint16	DisplayColor;
+	pixel_t	DisplayColor;
 
 	bool8	Multi;
 	char	CartAName[PATH_MAX + 1];
 	char	CartBName[PATH_MAX + 1];
+	char	ROMStoreDir[PATH_MAX + 1];
 
 	bool8	DisableGameSpecificHacks;
 	bool8	ShutdownMaster;
@@ -428,9 +429,11 @@ struct SSettings
 	bool8	NetPlayServer;
 	char	ServerName[128];
 	int		Port;
+	uint32	NetPlayMaxClients;
 
 	bool8	MovieTruncate;
 	bool8	MovieNotifyIgnored;
+	uint32	MovieKeyframeInterval;
 	bool8	WrongMovieStateProtection;
 	bool8	DumpStreams;
 	int		DumpStreamsMaxFrames;
@@ -438,6 +441,7 @@ struct SSettings
 	bool8	TakeScreenshot;
 	int8	StretchScreenshots;
 	bool8	SnapshotScreenshots;
+	uint8	SnapshotCompression;
 
 	bool8	ApplyCheats;
 	bool8	NoPatch;
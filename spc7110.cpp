@@ -225,6 +225,11 @@ void S9xResetSPC7110 (void)
 	s7emu.reset();
 }
 
+void S9xSPC7110FlushCache (void)
+{
+	s7emu.decomp.flush_cache();
+}
+
 static void SetSPC7110SRAMMap (uint8 newstate)
 {
 	if (newstate & 0x80)
@@ -382,6 +387,8 @@ void S9xSPC7110PreSaveState (void)
 	s7snap.rtc_mode  = (int32)  s7emu.rtc_mode;
 	s7snap.rtc_index = (uint32) s7emu.rtc_index;
 
+	s7emu.decomp.sync();
+
 	s7snap.decomp_mode   = (uint32) s7emu.decomp.decomp_mode;
 	s7snap.decomp_offset = (uint32) s7emu.decomp.decomp_offset;
 
@@ -463,6 +470,9 @@ void S9xSPC7110PostLoadState (int version)
 	s7emu.rtc_mode  = (SPC7110::RTC_Mode)  s7snap.rtc_mode;
 	s7emu.rtc_index = (unsigned)           s7snap.rtc_index;
 
+	s7emu.decomp.stream       = NULL;
+	s7emu.decomp.decoder_live = true;
+
 	s7emu.decomp.decomp_mode   = (unsigned) s7snap.decomp_mode;
 	s7emu.decomp.decomp_offset = (unsigned) s7snap.decomp_offset;
 
@@ -267,6 +267,7 @@ void S9xInitSPC7110 (void);
 void S9xResetSPC7110 (void);
 void S9xSPC7110PreSaveState (void);
 void S9xSPC7110PostLoadState (int);
+void S9xSPC7110FlushCache (void);
 void S9xSetSPC7110 (uint8, uint16);
 uint8 S9xGetSPC7110 (uint16);
 uint8 S9xGetSPC7110Byte (uint32);
@@ -21,11 +21,23 @@
 uint8 SPC7110Decomp::read() {
   if(decomp_buffer_length == 0) {
     //decompress at least (decomp_buffer_size / 2) bytes to the buffer
-    switch(decomp_mode) {
-      case 0: mode0(false); break;
-      case 1: mode1(false); break;
-      case 2: mode2(false); break;
-      default: return 0x00;
+    if(decomp_mode > 2) return 0x00;
+
+    if(stream && stream_pos < stream->length) {
+      //replay the next chunk from the cache
+      unsigned length = cached_chunk_length();
+      for(unsigned i = 0; i < length; i++) write(stream->data[stream_pos + i]);
+      stream_pos += length;
+    } else {
+      if(decoder_live == false) {
+        load_state(stream->end);
+        decoder_live = true;
+      }
+      decode();
+      if(stream) {
+        if(stream_pos == stream->length && append_stream(decomp_buffer_length)) save_state(stream->end);
+        stream_pos += decomp_buffer_length;
+      }
     }
   }
 
@@ -55,28 +67,104 @@ void SPC7110Decomp::init(unsigned mode, unsigned offset, unsigned index) {
   decomp_buffer_wroffset = 0;
   decomp_buffer_length   = 0;
 
-  //reset context states
-  for(unsigned i = 0; i < 32; i++) {
-    context[i].index  = 0;
-    context[i].invert = 0;
-  }
+  stream = 0;
+  stream_pos = 0;
+  decoder_live = true;
+
+  if(mode <= 2 && (stream = find_stream(mode, offset))) {
+    //already decompressed once: replay from the cache, decode only past its end
+    stream->last_use = ++stream_clock;
+    cache_buffer_index = 0;
+    decoder_live = false;
+  } else {
+    //reset context states
+    for(unsigned i = 0; i < 32; i++) {
+      context[i].index  = 0;
+      context[i].invert = 0;
+    }
 
-  switch(decomp_mode) {
-    case 0: mode0(true); break;
-    case 1: mode1(true); break;
-    case 2: mode2(true); break;
+    switch(decomp_mode) {
+      case 0: mode0(true); break;
+      case 1: mode1(true); break;
+      case 2: mode2(true); break;
+    }
+
+    if(mode <= 2 && (stream = new_stream(mode, offset))) {
+      save_state(stream->start);
+      stream->end = stream->start;
+    }
   }
 
   //decompress up to requested output data index
   while(index--) read();
 }
 
+void SPC7110Decomp::decode() {
+  switch(decomp_mode) {
+    case 0: mode0(false); break;
+    case 1: mode1(false); break;
+    case 2: mode2(false); break;
+  }
+}
+
+void SPC7110Decomp::sync() {
+  //bring the decoder registers up to the point a cached stream has been replayed to
+  if(decoder_live == true) return;
+
+  if(stream_pos == stream->length) {
+    load_state(stream->end);
+  } else {
+    uint8 buffer[decomp_buffer_size];
+    unsigned rdoffset = decomp_buffer_rdoffset;
+    unsigned wroffset = decomp_buffer_wroffset;
+    unsigned length   = decomp_buffer_length;
+    memcpy(buffer, decomp_buffer, decomp_buffer_size);
+
+    load_state(stream->start);
+    for(unsigned pos = 0; pos < stream_pos; pos += decomp_buffer_length) {
+      decomp_buffer_length = 0;
+      decode();
+    }
+
+    memcpy(decomp_buffer, buffer, decomp_buffer_size);
+    decomp_buffer_rdoffset = rdoffset;
+    decomp_buffer_wroffset = wroffset;
+    decomp_buffer_length   = length;
+
+    //the cache is only extended from its end; decode the rest of this stream uncached
+    stream = 0;
+  }
+
+  decoder_live = true;
+}
+
 //
 
-void SPC7110Decomp::mode0(bool init) {
-  static uint8 val, in, span;
-  static int out, inverts, lps, in_count;
+inline unsigned SPC7110Decomp::getbits(unsigned n) {
+  unsigned bits = 0;
+  while(n) {
+    unsigned count = n < (unsigned)in_count ? n : (unsigned)in_count;
+    bits = (bits << count) + (in >> (8 - count));
+    in <<= count;
+    n -= count;
+    if((in_count -= count) == 0) {
+      in = dataread();
+      in_count = 8;
+    }
+  }
+  return bits;
+}
 
+inline unsigned SPC7110Decomp::renormalize() {
+  unsigned shift = renorm_shift[span];
+  if(shift) {
+    span = (span << shift) + (1 << shift) - 1;
+    val = (val << shift) + getbits(shift);
+  }
+  return shift;
+}
+
+void SPC7110Decomp::mode0(bool init) {
   if(init == true) {
     out = inverts = lps = 0;
     span = 0xff;
@@ -111,19 +199,7 @@ void SPC7110Decomp::mode0(bool init) {
       }
 
       //renormalize
-      unsigned shift = 0;
-      while(span < 0x7f) {
-        shift++;
-
-        span = (span << 1) + 1;
-        val = (val << 1) + (in >> 7);
-
-        in <<= 1;
-        if(--in_count == 0) {
-          in = dataread();
-          in_count = 8;
-        }
-      }
+      unsigned shift = renormalize();
 
       //update processing info
       lps = (lps << 1) + flag_lps;
@@ -141,10 +217,6 @@ void SPC7110Decomp::mode0(bool init) {
 }
 
 void SPC7110Decomp::mode1(bool init) {
-  static unsigned pixelorder[4], realorder[4];
-  static uint8 in, val, span;
-  static int out, inverts, lps, in_count;
-
   if(init == true) {
     for(unsigned i = 0; i < 4; i++) pixelorder[i] = i;
     out = inverts = lps = 0;
@@ -204,19 +276,7 @@ void SPC7110Decomp::mode1(bool init) {
         }
 
         //renormalize
-        unsigned shift = 0;
-        while(span < 0x7f) {
-          shift++;
-
-          span = (span << 1) + 1;
-          val = (val << 1) + (in >> 7);
-
-          in <<= 1;
-          if(--in_count == 0) {
-            in = dataread();
-            in_count = 8;
-          }
-        }
+        unsigned shift = renormalize();
 
         //update processing info
         lps = (lps << 1) + flag_lps;
@@ -244,11 +304,6 @@ void SPC7110Decomp::mode1(bool init) {
 }
 
 void SPC7110Decomp::mode2(bool init) {
-  static unsigned pixelorder[16], realorder[16];
-  static uint8 bitplanebuffer[16], buffer_index;
-  static uint8 in, val, span;
-  static int out0, out1, inverts, lps, in_count;
-
   if(init == true) {
     for(unsigned i = 0; i < 16; i++) pixelorder[i] = i;
     buffer_index = 0;
@@ -310,19 +365,7 @@ void SPC7110Decomp::mode2(bool init) {
         }
 
         //renormalize
-        unsigned shift = 0;
-        while(span < 0x7f) {
-          shift++;
-
-          span = (span << 1) + 1;
-          val = (val << 1) + (in >> 7);
-
-          in <<= 1;
-          if(--in_count == 0) {
-            in = dataread();
-            in_count = 8;
-          }
-        }
+        unsigned shift = renormalize();
 
         //update processing info
         lps = (lps << 1) + flag_lps;
@@ -487,6 +530,137 @@ unsigned SPC7110Decomp::morton_4x8(unsigned data) {
 
 //
 
+void SPC7110Decomp::save_state(State &state) {
+  memcpy(state.context, context, sizeof(context));
+  state.decomp_offset = decomp_offset;
+  state.val = val;
+  state.in = in;
+  state.span = span;
+  state.out = out;
+  state.out0 = out0;
+  state.out1 = out1;
+  state.inverts = inverts;
+  state.lps = lps;
+  state.in_count = in_count;
+  memcpy(state.pixelorder, pixelorder, sizeof(pixelorder));
+  memcpy(state.realorder, realorder, sizeof(realorder));
+  memcpy(state.bitplanebuffer, bitplanebuffer, sizeof(bitplanebuffer));
+  state.buffer_index = buffer_index;
+}
+
+void SPC7110Decomp::load_state(const State &state) {
+  memcpy(context, state.context, sizeof(context));
+  decomp_offset = state.decomp_offset;
+  val = state.val;
+  in = state.in;
+  span = state.span;
+  out = state.out;
+  out0 = state.out0;
+  out1 = state.out1;
+  inverts = state.inverts;
+  lps = state.lps;
+  in_count = state.in_count;
+  memcpy(pixelorder, state.pixelorder, sizeof(pixelorder));
+  memcpy(realorder, state.realorder, sizeof(realorder));
+  memcpy(bitplanebuffer, state.bitplanebuffer, sizeof(bitplanebuffer));
+  buffer_index = state.buffer_index;
+}
+
+unsigned SPC7110Decomp::cached_chunk_length() {
+  //the decoder's own chunk sizes, so that stream_pos always falls on a saved state
+  if(decomp_mode != 2) return decomp_buffer_size >> 1;
+
+  unsigned length = 0;
+  while(length < (decomp_buffer_size >> 1)) {
+    length += 2;
+    cache_buffer_index += 2;
+    if(cache_buffer_index == 16) {
+      length += 16;
+      cache_buffer_index = 0;
+    }
+  }
+  return length;
+}
+
+SPC7110Decomp::Stream *SPC7110Decomp::find_stream(unsigned mode, unsigned offset) {
+  for(unsigned i = 0; i < stream_count; i++) {
+    if(stream_cache[i].mode == mode && stream_cache[i].offset == offset) return &stream_cache[i];
+  }
+  return 0;
+}
+
+SPC7110Decomp::Stream *SPC7110Decomp::new_stream(unsigned mode, unsigned offset) {
+  while(stream_count >= stream_cache_entries) {
+    if(evict_stream() == false) return 0;
+  }
+
+  Stream *s = &stream_cache[stream_count++];
+  s->mode = mode;
+  s->offset = offset;
+  s->data = 0;
+  s->length = 0;
+  s->capacity = 0;
+  s->last_use = ++stream_clock;
+  return s;
+}
+
+void SPC7110Decomp::free_stream(Stream *s) {
+  stream_bytes -= s->capacity;
+  free(s->data);
+
+  //keep the table packed; the active stream may be the one that moves
+  Stream *last = &stream_cache[--stream_count];
+  if(s != last) {
+    *s = *last;
+    if(stream == last) stream = s;
+  }
+}
+
+bool SPC7110Decomp::evict_stream() {
+  Stream *lru = 0;
+  for(unsigned i = 0; i < stream_count; i++) {
+    if(&stream_cache[i] == stream) continue;
+    if(!lru || stream_cache[i].last_use < lru->last_use) lru = &stream_cache[i];
+  }
+  if(!lru) return false;
+
+  free_stream(lru);
+  return true;
+}
+
+bool SPC7110Decomp::append_stream(unsigned length) {
+  if(stream->length + length > stream_length_limit) return false;
+
+  if(stream->length + length > stream->capacity) {
+    unsigned capacity = stream->capacity ? stream->capacity << 1 : 0x1000;
+    while(stream_bytes + capacity - stream->capacity > stream_cache_limit) {
+      if(evict_stream() == false) return false;
+    }
+
+    uint8 *data = (uint8 *)realloc(stream->data, capacity);
+    if(!data) return false;
+
+    stream_bytes += capacity - stream->capacity;
+    stream->data = data;
+    stream->capacity = capacity;
+  }
+
+  for(unsigned i = 0; i < length; i++) {
+    stream->data[stream->length + i] = decomp_buffer[(decomp_buffer_rdoffset + i) & (decomp_buffer_size - 1)];
+  }
+  stream->length += length;
+  return true;
+}
+
+void SPC7110Decomp::flush_cache() {
+  sync();
+  stream = 0;
+
+  for(unsigned i = 0; i < stream_count; i++) free(stream_cache[i].data);
+  stream_count = 0;
+  stream_bytes = 0;
+}
+
 void SPC7110Decomp::reset() {
   //mode 3 is invalid; this is treated as a special case to always return 0x00
   //set to mode 3 so that reading decomp port before starting first decomp will return 0x00
@@ -495,12 +669,28 @@ void SPC7110Decomp::reset() {
   decomp_buffer_rdoffset = 0;
   decomp_buffer_wroffset = 0;
   decomp_buffer_length   = 0;
+
+  flush_cache();
 }
 
 SPC7110Decomp::SPC7110Decomp() {
   decomp_buffer = new uint8_t[decomp_buffer_size];
+
+  stream = 0;
+  stream_pos = 0;
+  decoder_live = true;
+  stream_count = 0;
+  stream_bytes = 0;
+  stream_clock = 0;
   reset();
 
+  //initialize renormalization shift counts
+  for(unsigned i = 0; i < 256; i++) {
+    unsigned shift = 0;
+    for(unsigned span = i; span < 0x7f; span = (span << 1) + 1) shift++;
+    renorm_shift[i] = shift;
+  }
+
   //initialize reverse morton lookup tables
   for(unsigned i = 0; i < 256; i++) {
     #define map(x, y) (((i >> x) & 1) << y)
@@ -523,6 +713,7 @@ SPC7110Decomp::SPC7110Decomp() {
 }
 
 SPC7110Decomp::~SPC7110Decomp() {
+  for(unsigned i = 0; i < stream_count; i++) free(stream_cache[i].data);
   delete[] decomp_buffer;
 }
 
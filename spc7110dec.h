@@ -24,6 +24,8 @@ public:
   uint8 read();
   void init(unsigned mode, unsigned offset, unsigned index);
   void reset();
+  void sync();
+  void flush_cache();
 
   SPC7110Decomp();
   ~SPC7110Decomp();
@@ -44,6 +46,18 @@ public:
   void mode0(bool init);
   void mode1(bool init);
   void mode2(bool init);
+  void decode();
+
+  //arithmetic decoder registers, shared by all three modes
+  uint8 val, in, span;
+  int out, out0, out1, inverts, lps, in_count;
+  unsigned pixelorder[16], realorder[16];
+  uint8 bitplanebuffer[16], buffer_index;
+
+  //renormalize() shifts in as many bits as span needs in one step
+  uint8 renorm_shift[256];
+  unsigned getbits(unsigned n);
+  unsigned renormalize();
 
   static const uint8 evolution_table[53][4];
   static const uint8 mode2_context_table[32][2];
@@ -62,6 +76,48 @@ public:
   unsigned morton32[4][256];
   unsigned morton_2x8(unsigned data);
   unsigned morton_4x8(unsigned data);
+
+  //decoder state at a chunk boundary of a cached stream
+  struct State {
+    ContextState context[32];
+    unsigned decomp_offset;
+    uint8 val, in, span;
+    int out, out0, out1, inverts, lps, in_count;
+    unsigned pixelorder[16], realorder[16];
+    uint8 bitplanebuffer[16], buffer_index;
+  };
+
+  void save_state(State &state);
+  void load_state(const State &state);
+
+  //decompressed streams, keyed by mode and data offset, evicted least recently used first
+  struct Stream {
+    unsigned mode, offset;
+    uint8 *data;
+    unsigned length, capacity;
+    unsigned last_use;
+    State start, end;
+  };
+
+  enum { stream_cache_entries = 256 };
+  enum { stream_cache_limit = 4 * 1024 * 1024 };
+  enum { stream_length_limit = 0x10000 };
+  Stream stream_cache[stream_cache_entries];
+  unsigned stream_count;
+  unsigned stream_bytes;
+  unsigned stream_clock;
+
+  Stream *stream;      //stream being read, or NULL when decoding uncached
+  unsigned stream_pos; //bytes of the stream written to decomp_buffer so far
+  bool decoder_live;   //decoder registers hold the state at stream_pos
+  unsigned cache_buffer_index;
+
+  Stream *find_stream(unsigned mode, unsigned offset);
+  Stream *new_stream(unsigned mode, unsigned offset);
+  void free_stream(Stream *s);
+  bool evict_stream();
+  bool append_stream(unsigned length);
+  unsigned cached_chunk_length();
 };
 
 #endif
@@ -473,6 +473,76 @@ static uint8 ConvertTile4h_even (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 
 #undef DOBIT
 
+void S9xResetTileCache (void)
+{
+	for (int s = 0; s < TILE_CACHE_SETS; s++)
+	{
+		for (int w = 0; w < TILE_CACHE_WAYS; w++)
+		{
+			IPPU.TileCache.Set[s].Tag[w]   = TILE_CACHE_EMPTY;
+			IPPU.TileCache.Set[s].Slot[w]  = s * TILE_CACHE_WAYS + w;
+			IPPU.TileCache.Set[s].Blank[w] = FALSE;
+		}
+	}
+
+	IPPU.TileCache.Hits      = 0;
+	IPPU.TileCache.Misses    = 0;
+	IPPU.TileCache.Evictions = 0;
+}
+
+// Returns the decoded tile, converting it into the least recently used way of its set on a miss.
+
+static inline uint8 * GetCachedTile (uint32 Type, uint8 (*ConvertTile) (uint8 *, uint32, uint32), uint32 TileNumber, uint32 TileAddr, uint32 Tile, bool8 *Blank)
+{
+	struct TileCacheSet	*set = &IPPU.TileCache.Set[TILE_CACHE_SET(Type, TileNumber)];
+	uint16				tag  = TILE_CACHE_TAG(Type, TileNumber);
+	uint16				slot;
+	uint8				blank;
+	int					w;
+
+	if (set->Tag[0] == tag)
+	{
+		IPPU.TileCache.Hits++;
+		*Blank = set->Blank[0];
+		return (&IPPU.TileCache.Data[set->Slot[0] << 6]);
+	}
+
+	for (w = 1; w < TILE_CACHE_WAYS; w++)
+		if (set->Tag[w] == tag)
+			break;
+
+	if (w < TILE_CACHE_WAYS)
+	{
+		IPPU.TileCache.Hits++;
+		slot  = set->Slot[w];
+		blank = set->Blank[w];
+	}
+	else
+	{
+		w = TILE_CACHE_WAYS - 1;
+		if (set->Tag[w] != TILE_CACHE_EMPTY)
+			IPPU.TileCache.Evictions++;
+
+		IPPU.TileCache.Misses++;
+		slot  = set->Slot[w];
+		blank = (ConvertTile(&IPPU.TileCache.Data[slot << 6], TileAddr, Tile) == BLANK_TILE);
+	}
+
+	for (; w > 0; w--)
+	{
+		set->Tag[w]   = set->Tag[w - 1];
+		set->Slot[w]  = set->Slot[w - 1];
+		set->Blank[w] = set->Blank[w - 1];
+	}
+
+	set->Tag[0]   = tag;
+	set->Slot[0]  = slot;
+	set->Blank[0] = blank;
+
+	*Blank = blank;
+	return (&IPPU.TileCache.Data[slot << 6]);
+}
+
 // First-level include: Get all the renderers.
 
 #include "tile.cpp"
@@ -606,8 +676,7 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 	{
 		case 8:
 			BG.ConvertTile      = BG.ConvertTileFlip = ConvertTile8;
-			BG.Buffer           = BG.BufferFlip      = IPPU.TileCache[TILE_8BIT];
-			BG.Buffered         = BG.BufferedFlip    = IPPU.TileCached[TILE_8BIT];
+			BG.TileType         = BG.TileTypeFlip    = TILE_8BIT;
 			BG.TileShift        = 6;
 			BG.PaletteShift     = 0;
 			BG.PaletteMask      = 0;
@@ -621,27 +690,22 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 				if (sub || mosaic)
 				{
 					BG.ConvertTile     = ConvertTile4h_even;
-					BG.Buffer          = IPPU.TileCache[TILE_4BIT_EVEN];
-					BG.Buffered        = IPPU.TileCached[TILE_4BIT_EVEN];
+					BG.TileType        = TILE_4BIT_EVEN;
 					BG.ConvertTileFlip = ConvertTile4h_odd;
-					BG.BufferFlip      = IPPU.TileCache[TILE_4BIT_ODD];
-					BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT_ODD];
+					BG.TileTypeFlip    = TILE_4BIT_ODD;
 				}
 				else
 				{
 					BG.ConvertTile     = ConvertTile4h_odd;
-					BG.Buffer          = IPPU.TileCache[TILE_4BIT_ODD];
-					BG.Buffered        = IPPU.TileCached[TILE_4BIT_ODD];
+					BG.TileType        = TILE_4BIT_ODD;
 					BG.ConvertTileFlip = ConvertTile4h_even;
-					BG.BufferFlip      = IPPU.TileCache[TILE_4BIT_EVEN];
-					BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT_EVEN];
+					BG.TileTypeFlip    = TILE_4BIT_EVEN;
 				}
 			}
 			else
 			{
 				BG.ConvertTile = BG.ConvertTileFlip = ConvertTile4;
-				BG.Buffer      = BG.BufferFlip      = IPPU.TileCache[TILE_4BIT];
-				BG.Buffered    = BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT];
+				BG.TileType    = BG.TileTypeFlip    = TILE_4BIT;
 			}
 
 			BG.TileShift        = 5;
@@ -657,27 +721,22 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 				if (sub || mosaic)
 				{
 					BG.ConvertTile     = ConvertTile2h_even;
-					BG.Buffer          = IPPU.TileCache[TILE_2BIT_EVEN];
-					BG.Buffered        = IPPU.TileCached[TILE_2BIT_EVEN];
+					BG.TileType        = TILE_2BIT_EVEN;
 					BG.ConvertTileFlip = ConvertTile2h_odd;
-					BG.BufferFlip      = IPPU.TileCache[TILE_2BIT_ODD];
-					BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT_ODD];
+					BG.TileTypeFlip    = TILE_2BIT_ODD;
 				}
 				else
 				{
 					BG.ConvertTile     = ConvertTile2h_odd;
-					BG.Buffer          = IPPU.TileCache[TILE_2BIT_ODD];
-					BG.Buffered        = IPPU.TileCached[TILE_2BIT_ODD];
+					BG.TileType        = TILE_2BIT_ODD;
 					BG.ConvertTileFlip = ConvertTile2h_even;
-					BG.BufferFlip      = IPPU.TileCache[TILE_2BIT_EVEN];
-					BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT_EVEN];
+					BG.TileTypeFlip    = TILE_2BIT_EVEN;
 				}
 			}
 			else
 			{
 				BG.ConvertTile = BG.ConvertTileFlip = ConvertTile2;
-				BG.Buffer      = BG.BufferFlip      = IPPU.TileCache[TILE_2BIT];
-				BG.Buffered    = BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT];
+				BG.TileType    = BG.TileTypeFlip    = TILE_2BIT;
 			}
 
 			BG.TileShift        = 4;
@@ -696,26 +755,19 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 
 #define GET_CACHED_TILE() \
 	uint32	TileNumber; \
+	bool8	TileBlank; \
 	uint32	TileAddr = BG.TileAddress + ((Tile & 0x3ff) << BG.TileShift); \
 	if (Tile & 0x100) \
 		TileAddr += BG.NameSelect; \
 	TileAddr &= 0xffff; \
 	TileNumber = TileAddr >> BG.TileShift; \
 	if (Tile & H_FLIP) \
-	{ \
-		pCache = &BG.BufferFlip[TileNumber << 6]; \
-		if (!BG.BufferedFlip[TileNumber]) \
-			BG.BufferedFlip[TileNumber] = BG.ConvertTileFlip(pCache, TileAddr, Tile & 0x3ff); \
-	} \
+		pCache = GetCachedTile(BG.TileTypeFlip, BG.ConvertTileFlip, TileNumber, TileAddr, Tile & 0x3ff, &TileBlank); \
 	else \
-	{ \
-		pCache = &BG.Buffer[TileNumber << 6]; \
-		if (!BG.Buffered[TileNumber]) \
-			BG.Buffered[TileNumber] = BG.ConvertTile(pCache, TileAddr, Tile & 0x3ff); \
-	}
+		pCache = GetCachedTile(BG.TileType, BG.ConvertTile, TileNumber, TileAddr, Tile & 0x3ff, &TileBlank)
 
 #define IS_BLANK_TILE() \
-	(BG.Buffered[TileNumber] == BLANK_TILE)
+	(TileBlank)
 
 #define SELECT_PALETTE() \
 	if (BG.DirectColourMode) \
@@ -22,6 +22,7 @@
 
 
 static snes_video_refresh_t s9x_video_cb = NULL;
+static snes_video_refresh_xrgb8888_t s9x_video_xrgb8888_cb = NULL;
 static snes_audio_sample_t s9x_audio_cb = NULL;
 static snes_input_poll_t s9x_poller_cb = NULL;
 static snes_input_state_t s9x_input_state_cb = NULL;
@@ -31,6 +32,20 @@ void snes_set_video_refresh(snes_video_refresh_t cb)
    s9x_video_cb = cb;
 }
 
+void snes_set_video_refresh_xrgb8888(snes_video_refresh_xrgb8888_t cb)
+{
+   s9x_video_xrgb8888_cb = cb;
+}
+
+bool snes_video_xrgb8888()
+{
+#ifdef GFX_XRGB8888
+   return true;
+#else
+   return false;
+#endif
+}
+
 void snes_set_audio_sample(snes_audio_sample_t cb)
 {
    s9x_audio_cb = cb;
@@ -158,6 +173,10 @@ bool snes_load_cartridge_super_game_boy(
 
 static void map_buttons();
 
+// Framebuffer pitch in bytes: 1024 pixels per line, or 512 for interlaced frames.
+#define PITCH_NORMAL (1024 * sizeof(pixel_t))
+#define PITCH_INTERLACED (512 * sizeof(pixel_t))
+
 
 void snes_init()
 {
@@ -183,12 +202,18 @@ void snes_init()
    Settings.DumpStreamsMaxFrames = -1;
    Settings.StretchScreenshots = 1;
    Settings.SnapshotScreenshots = TRUE;
+   Settings.SnapshotCompression = SNAPSHOT_CODEC_FAST;
    Settings.SkipFrames = AUTO_FRAMERATE;
    Settings.TurboSkipFrames = 15;
    Settings.CartAName[0] = 0;
    Settings.CartBName[0] = 0;
    Settings.AutoSaveDelay = 1;
 
+   // Instances that share a ROM store map one copy of each ROM image.
+   const char *rom_store = getenv("SNES9X_ROM_STORE");
+   if (rom_store)
+      strncpy(Settings.ROMStoreDir, rom_store, PATH_MAX);
+
    CPU.Flags = 0;
 
    if (!Memory.Init() || !S9xInitAPU())
@@ -203,9 +228,11 @@ void snes_init()
    S9xSetSoundMute(FALSE);
    S9xSetSamplesAvailableCallback(S9xAudioCallback, NULL);
 
+#ifdef GFX_MULTI_FORMAT
    S9xSetRenderPixelFormat(RGB555);
-   GFX.Pitch = 2048;
-   GFX.Screen = (uint16*) calloc(1, GFX.Pitch * 512 * sizeof(uint16));
+#endif
+   GFX.Pitch = PITCH_NORMAL;
+   GFX.Screen = (pixel_t*) calloc(1, GFX.Pitch * 512 * sizeof(pixel_t));
    S9xGraphicsInit();
 
    S9xInitInputDevices();
@@ -400,42 +427,15 @@ static void report_buttons()
    }
 }
 
-#define S9X_TMP_ROM_FILE ".s9x.rom.sfc"
-#define S9X_TMP_STATE_FILE ".s9x.state.tmp"
-
-class s9x_tmp_file {
-private:
-	char tmp_file[PATH_MAX];
-public:
-	s9x_tmp_file(const char *filename) {
-#ifdef __WIN32__
-		GetTempPath(PATH_MAX,tmp_file);
-#else
-		sprintf(tmp_file,"%s","/tmp/");
-#endif
-		strcat(tmp_file,filename);
-	}
-	operator char *() { return tmp_file; }
-};
-
 bool snes_load_cartridge_normal(const char *, const uint8_t *rom_data, unsigned rom_size)
 {
-   // Hack. S9x cannot do stuff from RAM. <_<
-   FILE *file = fopen(s9x_tmp_file(S9X_TMP_ROM_FILE), "wb");
-   if (!file)
-      return false;
-
-   fwrite(rom_data, 1, rom_size, file);
-   fclose(file);
-
-   int loaded = Memory.LoadROM(s9x_tmp_file(S9X_TMP_ROM_FILE));
+   int loaded = Memory.LoadROMMem(rom_data, rom_size);
    if (!loaded)
    {
       fprintf(stderr, "[libsnes]: Rom loading failed...\n");
       return false;
    }
-   unlink(s9x_tmp_file(S9X_TMP_ROM_FILE));
-   
+
    return true;
 }
 
@@ -453,8 +453,6 @@ void snes_term()
    Memory.Deinit();
    S9xGraphicsDeinit();
    S9xUnmapAllControls();
-
-   unlink(s9x_tmp_file(S9X_TMP_STATE_FILE));
 }
 
 
@@ -514,61 +512,44 @@ void snes_set_cartridge_basename(const char*)
 #if S9X_SAVESTATES
 unsigned snes_serialize_size()
 {
-   if (S9xFreezeGame(s9x_tmp_file(S9X_TMP_STATE_FILE)) == FALSE)
+   uint8 *data;
+   uint32 size;
+
+   if (S9xFreezeGameMem(&data, &size) == FALSE)
    {
       return 0;
    }
 
-   FILE *tmp = fopen(s9x_tmp_file(S9X_TMP_STATE_FILE), "rb");
-   if (!tmp)
-      return 0;
-
-   fseek(tmp, 0, SEEK_END);
-   long len = ftell(tmp);
-   fclose(tmp);
-
-   return (unsigned)len;
+   delete [] data;
+   return (unsigned)size;
 }
 
 bool snes_serialize(uint8_t *data, unsigned size)
 { 
-   if (S9xFreezeGame(s9x_tmp_file(S9X_TMP_STATE_FILE)) == FALSE)
-   {
-      return false;
-   }
+   uint8 *state;
+   uint32 len;
 
-   FILE *tmp = fopen(s9x_tmp_file(S9X_TMP_STATE_FILE), "rb");
-   if (!tmp)
+   if (S9xFreezeGameMem(&state, &len) == FALSE)
    {
       return false;
    }
 
-   size_t len = fread(data, 1, size, tmp);
-   if (len != size)
+   if (len > size)
    {
-      fclose(tmp);
+      delete [] state;
       return false;
    }
-   fclose(tmp);
+
+   // gzread() ignores whatever follows the end of the gzip stream
+   memcpy(data, state, len);
+   memset(data + len, 0, size - len);
+   delete [] state;
    return true;
 }
 
 bool snes_unserialize(const uint8_t* data, unsigned size)
 { 
-   FILE *tmp = fopen(s9x_tmp_file(S9X_TMP_STATE_FILE), "wb");
-   if (!tmp)
-   {
-      return false;
-   }
-
-   fwrite(data, 1, size, tmp);
-   fclose(tmp);
-
-   if (S9xUnfreezeGame(s9x_tmp_file(S9X_TMP_STATE_FILE)) == FALSE)
-   {
-      return false;
-   }
-   return true;
+   return S9xUnfreezeGameMem(data, size) == SUCCESS;
 }
 #else
 unsigned snes_serialize_size() { return 0; }
@@ -576,27 +557,27 @@ bool snes_serialize(uint8_t *, unsigned) { return false; }
 bool snes_unserialize(const uint8_t*, unsigned) { return false; }
 #endif
 
-// Pitch 2048 -> 1024, only done once per res-change.
-static void pack_frame(uint16_t *frame, int width, int height)
+// Pitch 1024 -> 512 pixels, only done once per res-change.
+static void pack_frame(pixel_t *frame, int width, int height)
 {
    for (int y = 1; y < height; y++)
    {
-      uint16_t *src = frame + y * 1024;
-      uint16_t *dst = frame + y * 512;
+      pixel_t *src = frame + y * 1024;
+      pixel_t *dst = frame + y * 512;
 
-      memcpy(dst, src, width * sizeof(uint16_t));
+      memcpy(dst, src, width * sizeof(pixel_t));
    }
 }
 
-// Pitch 1024 -> 2048, only done once per res-change.
-static void stretch_frame(uint16_t *frame, int width, int height)
+// Pitch 512 -> 1024 pixels, only done once per res-change.
+static void stretch_frame(pixel_t *frame, int width, int height)
 {
    for (int y = height - 1; y >= 0; y--)
    {
-      uint16_t *src = frame + y * 512;
-      uint16_t *dst = frame + y * 1024;
+      pixel_t *src = frame + y * 512;
+      pixel_t *dst = frame + y * 1024;
 
-      memcpy(dst, src, width * sizeof(uint16_t));
+      memcpy(dst, src, width * sizeof(pixel_t));
    }
 }
 
@@ -604,18 +585,23 @@ bool8 S9xDeinitUpdate(int width, int height)
 {
    if (height == 448 || height == 478)
    {
-      if (GFX.Pitch == 2048)
+      if (GFX.Pitch == PITCH_NORMAL)
          pack_frame(GFX.Screen, width, height);
-      GFX.Pitch = 1024;
+      GFX.Pitch = PITCH_INTERLACED;
    }
    else
    {
-      if (GFX.Pitch == 1024)
+      if (GFX.Pitch == PITCH_INTERLACED)
          stretch_frame(GFX.Screen, width, height);
-      GFX.Pitch = 2048;
+      GFX.Pitch = PITCH_NORMAL;
    }
 
+#ifdef GFX_XRGB8888
+   if (s9x_video_xrgb8888_cb)
+      s9x_video_xrgb8888_cb(GFX.Screen, width, height);
+#else
    s9x_video_cb(GFX.Screen, width, height);
+#endif
    return TRUE;
 }
 
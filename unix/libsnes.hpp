@@ -278,6 +278,37 @@ typedef void (*snes_audio_sample_t)(uint16_t left, uint16_t right);
 typedef void (*snes_video_refresh_t)(const uint16_t *data, unsigned width,
         unsigned height);
 
+// snes_video_refresh_xrgb8888_t:
+//
+//    This callback delivers a single SNES frame like snes_video_refresh_t,
+//    but for cores that render natively at 32 bits per pixel. It is only
+//    called when snes_video_xrgb8888() returns true; such cores never call
+//    the 16-bit snes_video_refresh_t callback.
+//
+//    The memory layout is the same as described for snes_video_refresh_t
+//    when counted in pixels: the second scanline begins 512 pixels (2048
+//    bytes) after the first for interlaced frames, and 1024 pixels (4096
+//    bytes) after the first otherwise.
+//
+//    Each pixel contains a 24-bit RGB tuple: XXXXXXXXRRRRRRRRGGGGGGGGBBBBBBBB
+//    (XRGB8888). The top 8 bits are undefined. Colour math and brightness
+//    are computed at 8 bits per channel, so frames can be handed to an
+//    encoder without any conversion.
+//
+//    Parameters:
+//
+//      data:
+//          a pointer to the beginning of the framebuffer described above.
+//
+//      width:
+//          the width of the frame, in pixels.
+//
+//      height:
+//          the number of scanlines in the frame.
+
+typedef void (*snes_video_refresh_xrgb8888_t)(const uint32_t *data,
+        unsigned width, unsigned height);
+
 // snes_input_poll_t:
 //
 //    This callback requests that you poll your input devices for events, if
@@ -430,6 +461,32 @@ void snes_term(void);
 
 void snes_set_video_refresh(snes_video_refresh_t);
 
+// snes_set_video_refresh_xrgb8888:
+//
+//    Sets the callback that will receive new video frames from a core that
+//    renders in XRGB8888.
+//
+//    See the documentation for snes_video_refresh_xrgb8888_t for details.
+//
+//    Parameters:
+//
+//      A pointer to a function matching the snes_video_refresh_xrgb8888_t
+//      call signature.
+
+void snes_set_video_refresh_xrgb8888(snes_video_refresh_xrgb8888_t);
+
+// snes_video_xrgb8888:
+//
+//    Tells whether this core renders natively in XRGB8888.
+//
+//    Returns:
+//
+//      true if frames are delivered through the
+//      snes_video_refresh_xrgb8888_t callback, false if they are delivered
+//      through the 16-bit snes_video_refresh_t callback.
+
+bool snes_video_xrgb8888(void);
+
 // snes_set_audio_sample
 //
 //    Sets the callback that will receive new audio sample pairs.
@@ -0,0 +1,711 @@
+/***********************************************************************************
+  Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+
+  (c) Copyright 1996 - 2002  Gary Henderson (gary.henderson@ntlworld.com),
+                             Jerremy Koot (jkoot@snes9x.com)
+
+  (c) Copyright 2002 - 2004  Matthew Kendora
+
+  (c) Copyright 2002 - 2005  Peter Bortas (peter@bortas.org)
+
+  (c) Copyright 2004 - 2005  Joel Yliluoma (http://iki.fi/bisqwit/)
+
+  (c) Copyright 2001 - 2006  John Weidman (jweidman@slip.net)
+
+  (c) Copyright 2002 - 2006  funkyass (funkyass@spam.shaw.ca),
+                             Kris Bleakley (codeviolation@hotmail.com)
+
+  (c) Copyright 2002 - 2010  Brad Jorsch (anomie@users.sourceforge.net),
+                             Nach (n-a-c-h@users.sourceforge.net),
+                             zones (kasumitokoduck@yahoo.com)
+
+  (c) Copyright 2006 - 2007  nitsuja
+
+  (c) Copyright 2009 - 2010  BearOso,
+                             OV2
+
+
+  BS-X C emulator code
+  (c) Copyright 2005 - 2006  Dreamer Nom,
+                             zones
+
+  C4 x86 assembler and some C emulation code
+  (c) Copyright 2000 - 2003  _Demo_ (_demo_@zsnes.com),
+                             Nach,
+                             zsKnight (zsknight@zsnes.com)
+
+  C4 C++ code
+  (c) Copyright 2003 - 2006  Brad Jorsch,
+                             Nach
+
+  DSP-1 emulator code
+  (c) Copyright 1998 - 2006  _Demo_,
+                             Andreas Naive (andreasnaive@gmail.com),
+                             Gary Henderson,
+                             Ivar (ivar@snes9x.com),
+                             John Weidman,
+                             Kris Bleakley,
+                             Matthew Kendora,
+                             Nach,
+                             neviksti (neviksti@hotmail.com)
+
+  DSP-2 emulator code
+  (c) Copyright 2003         John Weidman,
+                             Kris Bleakley,
+                             Lord Nightmare (lord_nightmare@users.sourceforge.net),
+                             Matthew Kendora,
+                             neviksti
+
+  DSP-3 emulator code
+  (c) Copyright 2003 - 2006  John Weidman,
+                             Kris Bleakley,
+                             Lancer,
+                             z80 gaiden
+
+  DSP-4 emulator code
+  (c) Copyright 2004 - 2006  Dreamer Nom,
+                             John Weidman,
+                             Kris Bleakley,
+                             Nach,
+                             z80 gaiden
+
+  OBC1 emulator code
+  (c) Copyright 2001 - 2004  zsKnight,
+                             pagefault (pagefault@zsnes.com),
+                             Kris Bleakley
+                             Ported from x86 assembler to C by sanmaiwashi
+
+  SPC7110 and RTC C++ emulator code used in 1.39-1.51
+  (c) Copyright 2002         Matthew Kendora with research by
+                             zsKnight,
+                             John Weidman,
+                             Dark Force
+
+  SPC7110 and RTC C++ emulator code used in 1.52+
+  (c) Copyright 2009         byuu,
+                             neviksti
+
+  S-DD1 C emulator code
+  (c) Copyright 2003         Brad Jorsch with research by
+                             Andreas Naive,
+                             John Weidman
+
+  S-RTC C emulator code
+  (c) Copyright 2001 - 2006  byuu,
+                             John Weidman
+
+  ST010 C++ emulator code
+  (c) Copyright 2003         Feather,
+                             John Weidman,
+                             Kris Bleakley,
+                             Matthew Kendora
+
+  Super FX x86 assembler emulator code
+  (c) Copyright 1998 - 2003  _Demo_,
+                             pagefault,
+                             zsKnight
+
+  Super FX C emulator code
+  (c) Copyright 1997 - 1999  Ivar,
+                             Gary Henderson,
+                             John Weidman
+
+  Sound emulator code used in 1.5-1.51
+  (c) Copyright 1998 - 2003  Brad Martin
+  (c) Copyright 1998 - 2006  Charles Bilyue'
+
+  Sound emulator code used in 1.52+
+  (c) Copyright 2004 - 2007  Shay Green (gblargg@gmail.com)
+
+  SH assembler code partly based on x86 assembler code
+  (c) Copyright 2002 - 2004  Marcus Comstedt (marcus@mc.pp.se)
+
+  2xSaI filter
+  (c) Copyright 1999 - 2001  Derek Liauw Kie Fa
+
+  HQ2x, HQ3x, HQ4x filters
+  (c) Copyright 2003         Maxim Stepin (maxim@hiend3d.com)
+
+  NTSC filter
+  (c) Copyright 2006 - 2007  Shay Green
+
+  GTK+ GUI code
+  (c) Copyright 2004 - 2010  BearOso
+
+  Win32 GUI code
+  (c) Copyright 2003 - 2006  blip,
+                             funkyass,
+                             Matthew Kendora,
+                             Nach,
+                             nitsuja
+  (c) Copyright 2009 - 2010  OV2
+
+  Mac OS GUI code
+  (c) Copyright 1998 - 2001  John Stiles
+  (c) Copyright 2001 - 2010  zones
+
+
+  Specific ports contains the works of other authors. See headers in
+  individual files.
+
+
+  Snes9x homepage: http://www.snes9x.com/
+
+  Permission to use, copy, modify and/or distribute Snes9x in both binary
+  and source form, for non-commercial purposes, is hereby granted without
+  fee, providing that this license information and copyright notice appear
+  with all copies and any derived work.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event shall the authors be held liable for any damages
+  arising from the use of this software or it's derivatives.
+
+  Snes9x is freeware for PERSONAL USE only. Commercial users should
+  seek permission of the copyright holders first. Commercial use includes,
+  but is not limited to, charging money for Snes9x or software derived from
+  Snes9x, including Snes9x or derivatives in commercial game bundles, and/or
+  using Snes9x as a promotion for your commercial product.
+
+  The copyright holders request that bug fixes and improvements to the code
+  should be forwarded to them so everyone can benefit from the modifications
+  in future versions.
+
+  Super NES and Super Nintendo Entertainment System are trademarks of
+  Nintendo Co., Limited and its subsidiary companies.
+ ***********************************************************************************/
+
+
+// Headless movie verification: plays SMV movies at full speed and checks the
+// WRAM, VRAM and screen hashes at checkpoints against golden values.
+//
+//   snes9x-verify [-j jobs] [-every frames] [-keyframes frames] [-seek] [-save joblist] joblist
+//
+// Each line of the job list is
+//
+//   rom movie [frame:wram:vram:screen ...]
+//
+// with the hashes in hex. A job without golden hashes comes out as "new".
+// -save writes the job list back with the hashes that were computed.
+// -keyframes saves a state into the movie file every so many frames. Only the first job
+// on a movie writes them; without -keyframes the movie files are never modified.
+// -seek only checks the golden checkpoints, jumping to each from the movie's keyframes.
+// Every job runs in its own process, the results come out as JSON on stdout.
+
+#include "libsnes.hpp"
+
+#include "snes9x.h"
+#include "memmap.h"
+#include "gfx.h"
+#include "movie.h"
+#include "snapshot.h"
+#include "display.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MAX_CHECKPOINTS		4096
+
+struct SCheckpoint
+{
+	uint32	frame;
+	uint32	wram;
+	uint32	vram;
+	uint32	screen;
+};
+
+struct SVerifyJob
+{
+	char		*rom;
+	char		*movie;
+	int			num_golden;
+	SCheckpoint	*golden;
+	bool		write_keyframes;
+	FILE		*result;
+	pid_t		pid;
+	int			status;
+};
+
+static int			num_jobs;
+static SVerifyJob	*jobs;
+static uint32		check_every = 600;
+static uint32		keyframe_every = 0;
+static bool			seek_golden = false;
+
+static double now (void);
+static uint32 hash_bytes (uint32, const uint8 *, uint32);
+static void hash_state (SCheckpoint *);
+static void print_string (FILE *, const char *);
+static void print_checkpoint (FILE *, const SCheckpoint *);
+static bool is_checkpoint (const SVerifyJob *, uint32, uint32);
+static int run_job (const SVerifyJob *, FILE *);
+static bool same_file (const char *, const char *);
+static bool read_job_list (const char *);
+static void write_job_list (const char *);
+
+static void video_refresh (const uint16_t *, unsigned, unsigned) {}
+static void audio_sample (uint16_t, uint16_t) {}
+static void input_poll (void) {}
+static int16_t input_state (bool, unsigned, unsigned, unsigned) { return (0); }
+
+#ifdef DEBUGGER
+// The debugger switches the port's display in and out of text mode; there is none here.
+void S9xTextMode (void) {}
+void S9xGraphicsMode (void) {}
+#endif
+
+
+static double now (void)
+{
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+
+	return (tv.tv_sec + tv.tv_usec * 1e-6);
+}
+
+// FNV-1a
+static uint32 hash_bytes (uint32 h, const uint8 *data, uint32 size)
+{
+	for (uint32 i = 0; i < size; i++)
+		h = (h ^ data[i]) * 16777619;
+
+	return (h);
+}
+
+static void hash_state (SCheckpoint *c)
+{
+	const uint8	*line = (const uint8 *) GFX.Screen;
+	uint32		width = IPPU.RenderedScreenWidth * sizeof(pixel_t);
+
+	c->wram   = hash_bytes(2166136261u, Memory.RAM, 0x20000);
+	c->vram   = hash_bytes(2166136261u, Memory.VRAM, 0x10000);
+	c->screen = 2166136261u;
+
+	for (int y = 0; y < IPPU.RenderedScreenHeight; y++, line += GFX.Pitch)
+		c->screen = hash_bytes(c->screen, line, width);
+}
+
+static void print_string (FILE *fp, const char *s)
+{
+	fputc('"', fp);
+
+	for (; *s; s++)
+	{
+		if (*s == '"' || *s == '\\')
+			fprintf(fp, "\\%c", *s);
+		else
+		if ((uint8) *s < 0x20)
+			fprintf(fp, "\\u%04x", (uint8) *s);
+		else
+			fputc(*s, fp);
+	}
+
+	fputc('"', fp);
+}
+
+static void print_checkpoint (FILE *fp, const SCheckpoint *c)
+{
+	fprintf(fp, "{ \"frame\": %u, \"wram\": \"%08x\", \"vram\": \"%08x\", \"screen\": \"%08x\" }", c->frame, c->wram, c->vram, c->screen);
+}
+
+static bool is_checkpoint (const SVerifyJob *job, uint32 frame, uint32 length)
+{
+	if (frame == length || (check_every && frame % check_every == 0))
+		return (true);
+
+	for (int i = 0; i < job->num_golden; i++)
+	{
+		if (job->golden[i].frame == frame)
+			return (true);
+	}
+
+	return (false);
+}
+
+// Runs in the child process, writes the job's JSON object to 'out'.
+static int run_job (const SVerifyJob *job, FILE *out)
+{
+	static SCheckpoint	checks[MAX_CHECKPOINTS];
+	int					num_checks = 0, mismatch = -1;
+	uint8				*rom;
+	long				rom_size;
+	FILE				*fp;
+
+	if (!(fp = fopen(job->rom, "rb")))
+		return (1);
+
+	fseek(fp, 0, SEEK_END);
+	rom_size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	rom = new uint8[rom_size];
+	if (fread(rom, 1, rom_size, fp) != (size_t) rom_size)
+	{
+		fclose(fp);
+		return (1);
+	}
+
+	fclose(fp);
+
+	snes_init();
+	snes_set_video_refresh(video_refresh);
+	snes_set_audio_sample(audio_sample);
+	snes_set_input_poll(input_poll);
+	snes_set_input_state(input_state);
+
+	Settings.AutoDisplayMessages   = FALSE;
+	Settings.MovieKeyframeInterval = keyframe_every;
+
+	if (!snes_load_cartridge_normal(job->rom, rom, rom_size))
+		return (1);
+
+	delete [] rom;
+
+	// opening it read+write is what lets the keyframes go back into the file
+	if (S9xMovieOpen(job->movie, !job->write_keyframes) != SUCCESS)
+		return (1);
+
+	uint32	length = S9xMovieGetLength();
+	uint32	frames = 0;
+	double	start = now();
+
+	if (seek_golden && job->num_golden)
+	{
+		// the checkpoint frame itself is always run, so that it gets drawn
+		for (int i = 0; i < job->num_golden; i++)
+		{
+			uint32	frame = job->golden[i].frame;
+			int		left;
+
+			if (!frame || frame > length || (left = S9xMovieSeek(frame - 1)) < 0)
+				return (1);
+
+			for (left++; left > 0; left--, frames++)
+			{
+				IPPU.RenderThisFrame = (left == 1);
+				snes_run();
+			}
+
+			checks[num_checks].frame = frame;
+			hash_state(&checks[num_checks]);
+			num_checks++;
+		}
+	}
+	else
+	{
+		// only the frames that end on a checkpoint are drawn
+		for (uint32 frame = 1; frame <= length; frame++, frames++)
+		{
+			bool	check = is_checkpoint(job, frame, length) && num_checks < MAX_CHECKPOINTS;
+
+			IPPU.RenderThisFrame = check;
+			snes_run();
+
+			if (check)
+			{
+				checks[num_checks].frame = frame;
+				hash_state(&checks[num_checks]);
+				num_checks++;
+			}
+		}
+	}
+
+	double	seconds = now() - start;
+
+	// closing the movie writes out the keyframes
+	S9xMovieStop(TRUE);
+
+	for (int i = 0; i < job->num_golden && mismatch < 0; i++)
+	{
+		const SCheckpoint	*g = &job->golden[i];
+
+		for (int j = 0; j < num_checks; j++)
+		{
+			if (checks[j].frame == g->frame)
+			{
+				if (checks[j].wram != g->wram || checks[j].vram != g->vram || checks[j].screen != g->screen)
+					mismatch = j;
+				break;
+			}
+		}
+	}
+
+	fprintf(out, "{ \"rom\": ");
+	print_string(out, job->rom);
+	fprintf(out, ", \"movie\": ");
+	print_string(out, job->movie);
+	fprintf(out, ", \"status\": \"%s\"", !job->num_golden ? "new" : (mismatch < 0 ? "pass" : "fail"));
+	if (mismatch >= 0)
+		fprintf(out, ", \"first_mismatch\": %u", checks[mismatch].frame);
+	fprintf(out, ", \"frames\": %u, \"seconds\": %.3f, \"fps\": %.1f,\n      \"checkpoints\": [", frames, seconds, seconds > 0 ? frames / seconds : 0.0);
+
+	for (int j = 0; j < num_checks; j++)
+	{
+		fprintf(out, j ? ",\n        " : "\n        ");
+		print_checkpoint(out, &checks[j]);
+	}
+
+	fprintf(out, " ] }");
+	fflush(out);
+
+	return (!job->num_golden ? 3 : (mismatch < 0 ? 0 : 2));
+}
+
+static bool same_file (const char *a, const char *b)
+{
+	struct stat	sa, sb;
+
+	if (stat(a, &sa) || stat(b, &sb))
+		return (!strcmp(a, b));
+
+	return (sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino);
+}
+
+static bool read_job_list (const char *filename)
+{
+	char	line[4096];
+	int		max_jobs = 0;
+	FILE	*fp;
+
+	if (!(fp = fopen(filename, "r")))
+		return (false);
+
+	while (fgets(line, sizeof(line), fp))
+	{
+		char	*rom = strtok(line, " \t\r\n"), *movie, *tok;
+
+		if (!rom || *rom == '#')
+			continue;
+
+		if (!(movie = strtok(NULL, " \t\r\n")))
+		{
+			fprintf(stderr, "%s: no movie for %s\n", filename, rom);
+			continue;
+		}
+
+		if (num_jobs == max_jobs)
+		{
+			max_jobs = max_jobs ? max_jobs * 2 : 16;
+			jobs = (SVerifyJob *) realloc(jobs, max_jobs * sizeof(SVerifyJob));
+		}
+
+		SVerifyJob	*job = &jobs[num_jobs++];
+
+		memset(job, 0, sizeof(*job));
+		job->rom    = strdup(rom);
+		job->movie  = strdup(movie);
+		job->golden = new SCheckpoint[MAX_CHECKPOINTS];
+
+		// jobs run in parallel, so only one of them may write a given movie file
+		job->write_keyframes = keyframe_every != 0;
+		for (int i = 0; i < num_jobs - 1 && job->write_keyframes; i++)
+			if (same_file(jobs[i].movie, job->movie))
+				job->write_keyframes = false;
+
+		while ((tok = strtok(NULL, " \t\r\n")) && job->num_golden < MAX_CHECKPOINTS)
+		{
+			SCheckpoint	*g = &job->golden[job->num_golden];
+
+			if (sscanf(tok, "%u:%x:%x:%x", &g->frame, &g->wram, &g->vram, &g->screen) == 4)
+				job->num_golden++;
+			else
+				fprintf(stderr, "%s: bad checkpoint %s\n", filename, tok);
+		}
+	}
+
+	fclose(fp);
+
+	return (true);
+}
+
+// Writes the job list back with the checkpoints out of the JSON results.
+static void write_job_list (const char *filename)
+{
+	FILE	*fp;
+
+	if (!(fp = fopen(filename, "w")))
+	{
+		perror(filename);
+		return;
+	}
+
+	for (int i = 0; i < num_jobs; i++)
+	{
+		char		line[4096];
+		SCheckpoint	c;
+
+		fprintf(fp, "%s %s", jobs[i].rom, jobs[i].movie);
+
+		rewind(jobs[i].result);
+		while (fgets(line, sizeof(line), jobs[i].result))
+		{
+			char	*p = strstr(line, "{ \"frame\"");
+
+			if (p && sscanf(p, "{ \"frame\": %u, \"wram\": \"%x\", \"vram\": \"%x\", \"screen\": \"%x\"", &c.frame, &c.wram, &c.vram, &c.screen) == 4)
+				fprintf(fp, " %u:%08x:%08x:%08x", c.frame, c.wram, c.vram, c.screen);
+		}
+
+		fprintf(fp, "\n");
+	}
+
+	fclose(fp);
+}
+
+int main (int argc, char **argv)
+{
+	const char	*list = NULL, *save = NULL;
+	int			max_running = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-j") && i + 1 < argc)
+			max_running = atoi(argv[++i]);
+		else
+		if (!strcmp(argv[i], "-every") && i + 1 < argc)
+			check_every = (uint32) atoi(argv[++i]);
+		else
+		if (!strcmp(argv[i], "-keyframes") && i + 1 < argc)
+			keyframe_every = (uint32) atoi(argv[++i]);
+		else
+		if (!strcmp(argv[i], "-seek"))
+			seek_golden = true;
+		else
+		if (!strcmp(argv[i], "-save") && i + 1 < argc)
+			save = argv[++i];
+		else
+		if (argv[i][0] != '-' && !list)
+			list = argv[i];
+		else
+		{
+			list = NULL;
+			break;
+		}
+	}
+
+	if (!list)
+	{
+		fprintf(stderr, "usage: %s [-j jobs] [-every frames] [-keyframes frames] [-seek] [-save joblist] joblist\n", argv[0]);
+		return (1);
+	}
+
+	if (!read_job_list(list))
+	{
+		perror(list);
+		return (1);
+	}
+
+	if (max_running < 1)
+		max_running = 1;
+
+	fflush(stdout);
+
+	// one process per job, so the emulator's globals are never shared
+	int		next = 0, running = 0;
+	double	start = now();
+
+	while (next < num_jobs || running)
+	{
+		if (next < num_jobs && running < max_running)
+		{
+			SVerifyJob	*job = &jobs[next++];
+
+			job->result = tmpfile();
+			job->pid    = fork();
+
+			if (job->pid == 0)
+				_exit(job->result ? run_job(job, job->result) : 1);
+
+			if (job->pid > 0)
+				running++;
+			else
+				job->status = -1;
+
+			continue;
+		}
+
+		int		status;
+		pid_t	pid = wait(&status);
+
+		if (pid < 0)
+			break;
+
+		for (int i = 0; i < num_jobs; i++)
+		{
+			if (jobs[i].pid == pid)
+			{
+				jobs[i].status = status;
+				running--;
+			}
+		}
+	}
+
+	double	seconds = now() - start;
+	uint32	total_frames = 0;
+	int		passed = 0, failed = 0, fresh = 0, errors = 0;
+
+	printf("{\n  \"jobs\": [");
+
+	for (int i = 0; i < num_jobs; i++)
+	{
+		SVerifyJob	*job = &jobs[i];
+		char		buf[4096 + 1];
+		size_t		n, size = 0;
+		uint32		frames;
+
+		printf(i ? ",\n    " : "\n    ");
+
+		if (job->result)
+		{
+			rewind(job->result);
+			while ((n = fread(buf, 1, sizeof(buf) - 1, job->result)) > 0)
+			{
+				buf[n] = 0;
+
+				if (!size)
+				{
+					char	*p = strstr(buf, "\"frames\": ");
+					if (p && sscanf(p, "\"frames\": %u", &frames) == 1)
+						total_frames += frames;
+				}
+
+				fwrite(buf, 1, n, stdout);
+				size += n;
+			}
+		}
+
+		if (!size)
+		{
+			printf("{ \"rom\": ");
+			print_string(stdout, job->rom);
+			printf(", \"movie\": ");
+			print_string(stdout, job->movie);
+			if (job->status != -1 && WIFSIGNALED(job->status))
+				printf(", \"status\": \"error\", \"signal\": %d }", WTERMSIG(job->status));
+			else
+				printf(", \"status\": \"error\" }");
+			errors++;
+		}
+		else
+		if (WIFEXITED(job->status) && WEXITSTATUS(job->status) == 0)
+			passed++;
+		else
+		if (WIFEXITED(job->status) && WEXITSTATUS(job->status) == 3)
+			fresh++;
+		else
+			failed++;
+	}
+
+	printf(" ],\n  \"passed\": %d, \"failed\": %d, \"new\": %d, \"errors\": %d, \"frames\": %u, \"seconds\": %.3f, \"fps\": %.1f\n}\n",
+		passed, failed, fresh, errors, total_frames, seconds, seconds > 0 ? total_frames / seconds : 0.0);
+
+	if (save)
+		write_job_list(save);
+
+	return ((failed || errors) ? 1 : 0);
+}
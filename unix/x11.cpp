@@ -238,6 +238,11 @@ struct GUIData
 	int				mouse_y;
 	bool8			mod1_pressed;
 	bool8			no_repeat;
+	int				blit_threads;
+	bool8			blit_pending;
+	int				pending_height;
+	int				pending_copy_width;
+	int				pending_copy_height;
 #ifdef MITSHM
 	XShmSegmentInfo	sm_info;
 	bool8			use_shared_memory;
@@ -282,6 +287,7 @@ static void SetXRepeat (bool8);
 static void SetupImage (void);
 static void TakedownImage (void);
 static void Repaint (bool8);
+static void PresentImage (int, int, int);
 static void Convert16To24 (int, int);
 static void Convert16To24Packed (int, int);
 
@@ -301,6 +307,9 @@ void S9xExtraDisplayUsage (void)
 	S9xMessage(S9X_INFO, S9X_USAGE, "-v7                             Video mode: EPX");
 	S9xMessage(S9X_INFO, S9X_USAGE, "-v8                             Video mode: hq2x");
 	S9xMessage(S9X_INFO, S9X_USAGE, "");
+	S9xMessage(S9X_INFO, S9X_USAGE, "-blitthreads <num>              Filter each frame on <num> threads while the next");
+	S9xMessage(S9X_INFO, S9X_USAGE, "                                one is emulated (0: off, default)");
+	S9xMessage(S9X_INFO, S9X_USAGE, "");
 }
 
 void S9xParseDisplayArg (char **argv, int &i, int argc)
@@ -322,6 +331,14 @@ void S9xParseDisplayArg (char **argv, int &i, int argc)
 			case '8':	GUI.video_mode = VIDEOMODE_HQ2X;		break;
 		}
 	}
+	else
+	if (!strcasecmp(argv[i], "-blitthreads"))
+	{
+		if (i + 1 < argc)
+			GUI.blit_threads = atoi(argv[++i]);
+		else
+			S9xUsage();
+	}
 	else
 		S9xUsage();
 }
@@ -475,6 +492,8 @@ const char * S9xParseDisplayConfig (ConfigFile &conf, int pass)
 	else
 		GUI.video_mode = VIDEOMODE_BLOCKY;
 
+	GUI.blit_threads = conf.GetInt("Unix/X11::BlitThreads", 0);
+
 	return ("Unix/X11");
 }
 
@@ -566,6 +585,9 @@ void S9xInitDisplay (int argc, char **argv)
 	S9xBlitFilterInit();
 	S9xBlit2xSaIFilterInit();
 	S9xBlitHQ2xFilterInit();
+	if (GUI.blit_threads > 0)
+		S9xBlitPipelineInit(GUI.blit_threads);
+	GUI.blit_pending = FALSE;
 
 	XSetWindowAttributes	attrib;
 
@@ -636,6 +658,7 @@ void S9xDeinitDisplay (void)
 	TakedownImage();
 	XSync(GUI.display, False);
 	XCloseDisplay(GUI.display);
+	S9xBlitPipelineDeinit();
 	S9xBlitFilterDeinit();
 	S9xBlit2xSaIFilterDeinit();
 	S9xBlitHQ2xFilterDeinit();
@@ -643,6 +666,10 @@ void S9xDeinitDisplay (void)
 
 static void TakedownImage (void)
 {
+	// The filter may still be writing into the buffers
+	S9xBlitPipelineWait();
+	GUI.blit_pending = FALSE;
+
 	if (GUI.snes_buffer)
 	{
 		free(GUI.snes_buffer);
@@ -784,6 +811,15 @@ void S9xPutImage (int width, int height)
 	int			copyWidth, copyHeight;
 	Blitter		blitFn = NULL;
 
+	// With -blitthreads the previous frame has been filtering while this one was emulated.
+	// Show it now; blit_screen and the XDelta table are free again once it is done.
+	if (GUI.blit_pending)
+	{
+		S9xBlitPipelineWait();
+		GUI.blit_pending = FALSE;
+		PresentImage(GUI.pending_height, GUI.pending_copy_width, GUI.pending_copy_height);
+	}
+
 	if (GUI.video_mode == VIDEOMODE_BLOCKY || GUI.video_mode == VIDEOMODE_TV || GUI.video_mode == VIDEOMODE_SMOOTH)
 		if ((width <= SNES_WIDTH) && ((prevWidth != width) || (prevHeight != height)))
 			S9xBlitClearDelta();
@@ -825,9 +861,30 @@ void S9xPutImage (int width, int height)
 		blitFn = S9xBlitPixSmall16;
 	}
 
-	blitFn((uint8 *) GFX.Screen, GFX.Pitch, GUI.blit_screen, GUI.blit_screen_pitch, width, height);
+	if (GUI.blit_threads > 0)
+	{
+		// GFX.Screen is copied, so emulation can carry on drawing into it
+		S9xBlitPipelineSubmit(blitFn, (uint8 *) GFX.Screen, GFX.Pitch, GUI.blit_screen, GUI.blit_screen_pitch, width, height);
+		GUI.blit_pending        = TRUE;
+		GUI.pending_height      = height;
+		GUI.pending_copy_width  = copyWidth;
+		GUI.pending_copy_height = copyHeight;
+	}
+	else
+	{
+		blitFn((uint8 *) GFX.Screen, GFX.Pitch, GUI.blit_screen, GUI.blit_screen_pitch, width, height);
+		PresentImage(height, copyWidth, copyHeight);
+	}
 
-	if (height < prevHeight)
+	prevWidth  = width;
+	prevHeight = height;
+}
+
+static void PresentImage (int height, int copyWidth, int copyHeight)
+{
+	static int	shownHeight = 0;
+
+	if (height < shownHeight)
 	{
 		int	p = GUI.blit_screen_pitch >> 2;
 		for (int y = SNES_HEIGHT * 2; y < SNES_HEIGHT_EXTENDED * 2; y++)
@@ -848,8 +905,7 @@ void S9xPutImage (int width, int height)
 
 	Repaint(TRUE);
 
-	prevWidth  = width;
-	prevHeight = height;
+	shownHeight = height;
 }
 
 static void Convert16To24 (int width, int height)
@@ -942,7 +942,7 @@ void S9xWinScanJoypads ()
     if (Settings.NetPlay)
 	{
 		// Send joypad position update to server
-		S9xNPSendJoypadUpdate (joypads [GUI.NetplayUseJoypad1 ? 0 : NetPlay.Player-1]);
+		S9xNPSendJoypadUpdate (GUI.NetplayUseJoypad1 ? joypads [0] : NetPlay.Player <= NP_MAX_CLIENTS ? joypads [NetPlay.Player-1] : 0);
 
 		// set input from network
 		for (int J = 0; J < NP_MAX_CLIENTS; J++)